@@ -0,0 +1,202 @@
+#include "AudioSDL.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+// Frequency of the plain CHIP-8 buzzer
+const double TONE_FREQUENCY = 440.0;
+
+// Largest speed correction applied in master clock mode (0.5%)
+const double MAX_RATE_DEVIATION = 0.005;
+
+AudioSDL::AudioSDL()
+    : stream(nullptr), sampleRate(48000), deviceFrames(0), masterClock(false),
+      targetFrames(0), fractionalFrames(0.0), framesQueued(0), underruns(0),
+      toneOn(false), toneChangedNs(0), volume(0.25f),
+      lastToneOn(false), phase(0.0), playingTone(false), samples{},
+      lastLatencyUs(0), averageLatencyUs(0) {
+}
+
+AudioSDL::~AudioSDL() {
+    Shutdown();
+}
+
+bool AudioSDL::Initialize(int rate, int bufferFrames, bool useMasterClock) {
+    if (!SDL_InitSubSystem(SDL_INIT_AUDIO)) {
+        std::cerr << "SDL audio could not initialize! SDL Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    sampleRate = rate;
+    masterClock = useMasterClock;
+
+    // Device buffer size must be requested before the device is opened
+    if (bufferFrames > 0) {
+        SDL_SetHint(SDL_HINT_AUDIO_DEVICE_SAMPLE_FRAMES, std::to_string(bufferFrames).c_str());
+    }
+
+    SDL_AudioSpec spec;
+    spec.format = SDL_AUDIO_F32;
+    spec.channels = 1;
+    spec.freq = sampleRate;
+
+    // Without a callback SDL plays whatever the emulator queued
+    stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec,
+                                       masterClock ? nullptr : AudioCallback, this);
+    if (!stream) {
+        std::cerr << "Audio stream could not be opened! SDL Error: " << SDL_GetError() << std::endl;
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return false;
+    }
+
+    SDL_AudioSpec deviceSpec;
+    if (!SDL_GetAudioDeviceFormat(SDL_GetAudioStreamDevice(stream), &deviceSpec, &deviceFrames)) {
+        deviceFrames = bufferFrames;
+    }
+
+    // Keep two device buffers queued by default
+    targetFrames = std::max(deviceFrames, 256) * 2;
+    fractionalFrames = 0.0;
+    framesQueued = 0;
+    underruns = 0;
+
+    SDL_ResumeAudioStreamDevice(stream);
+
+    std::cout << "Audio initialized: " << sampleRate << " Hz, " << deviceFrames
+              << " frame device buffer (" << GetBufferLatencyMs() << " ms)"
+              << (masterClock ? ", audio clock is master" : "") << std::endl;
+    return true;
+}
+
+void AudioSDL::Shutdown() {
+    if (!stream) {
+        return;
+    }
+
+    SDL_DestroyAudioStream(stream);
+    stream = nullptr;
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+
+    if (masterClock) {
+        std::cout << "Audio underruns: " << underruns << std::endl;
+    }
+
+    if (averageLatencyUs > 0) {
+        std::cout << "Audio latency (sound timer to output): avg " << GetAverageLatencyMs()
+                  << " ms, last " << GetLastLatencyMs() << " ms" << std::endl;
+    }
+}
+
+void AudioSDL::SetTone(bool on) {
+    if (on == lastToneOn) {
+        return;
+    }
+
+    lastToneOn = on;
+    toneChangedNs.store(SDL_GetTicksNS(), std::memory_order_relaxed);
+    toneOn.store(on, std::memory_order_release);
+}
+
+void AudioSDL::SetVolume(float newVolume) {
+    volume.store(std::max(0.0f, std::min(newVolume, 1.0f)), std::memory_order_relaxed);
+}
+
+void AudioSDL::QueueCycle(double cycleMs) {
+    if (!stream || !masterClock) {
+        return;
+    }
+
+    if (framesQueued > 0 && GetQueuedFrames() == 0) {
+        ++underruns;
+    }
+
+    // Carry the fractional part so the long-run sample count stays exact
+    fractionalFrames += (double)sampleRate * cycleMs / 1000.0;
+    int framesToQueue = (int)fractionalFrames;
+    fractionalFrames -= framesToQueue;
+    framesQueued += framesToQueue;
+
+    while (framesToQueue > 0) {
+        int frames = std::min(framesToQueue, (int)(sizeof(samples) / sizeof(float)));
+        Generate(frames);
+        SDL_PutAudioStreamData(stream, samples, frames * (int)sizeof(float));
+        framesToQueue -= frames;
+    }
+}
+
+int AudioSDL::GetQueuedFrames() const {
+    if (!stream) {
+        return 0;
+    }
+
+    return std::max(0, SDL_GetAudioStreamQueued(stream)) / (int)sizeof(float);
+}
+
+void AudioSDL::SetTargetLatency(float milliseconds) {
+    targetFrames = std::max(64, (int)((float)sampleRate * milliseconds / 1000.0f));
+}
+
+double AudioSDL::GetRateAdjustment() const {
+    if (!stream || !masterClock || targetFrames <= 0) {
+        return 1.0;
+    }
+
+    // Run slightly faster while the queue is below target, slower while above
+    double deviation = (double)(targetFrames - GetQueuedFrames()) / (double)targetFrames;
+    deviation = std::max(-1.0, std::min(deviation, 1.0));
+    return 1.0 + deviation * MAX_RATE_DEVIATION;
+}
+
+float AudioSDL::GetBufferLatencyMs() const {
+    if (!stream || sampleRate <= 0) {
+        return 0.0f;
+    }
+
+    return (float)(deviceFrames + GetQueuedFrames()) * 1000.0f / (float)sampleRate;
+}
+
+void SDLCALL AudioSDL::AudioCallback(void* userdata, SDL_AudioStream* stream, int additionalAmount, int totalAmount) {
+    (void)totalAmount;
+    AudioSDL* audio = static_cast<AudioSDL*>(userdata);
+
+    int framesNeeded = additionalAmount / (int)sizeof(float);
+    while (framesNeeded > 0) {
+        int frames = std::min(framesNeeded, (int)(sizeof(audio->samples) / sizeof(float)));
+        audio->Generate(frames);
+        SDL_PutAudioStreamData(stream, audio->samples, frames * (int)sizeof(float));
+        framesNeeded -= frames;
+    }
+}
+
+void AudioSDL::Generate(int frameCount) {
+    bool on = toneOn.load(std::memory_order_acquire);
+    float amplitude = volume.load(std::memory_order_relaxed);
+
+    // Measure how long a sound timer edge took to reach the device buffer
+    if (on != playingTone) {
+        playingTone = on;
+        uint64_t changed = toneChangedNs.load(std::memory_order_relaxed);
+        uint64_t now = SDL_GetTicksNS();
+        if (changed != 0 && now >= changed) {
+            uint32_t latencyUs = (uint32_t)((now - changed) / 1000) +
+                                 (uint32_t)((uint64_t)deviceFrames * 1000000 / (uint64_t)sampleRate);
+            lastLatencyUs.store(latencyUs, std::memory_order_relaxed);
+            uint32_t average = averageLatencyUs.load(std::memory_order_relaxed);
+            averageLatencyUs.store(average == 0 ? latencyUs : (average * 7 + latencyUs) / 8,
+                                   std::memory_order_relaxed);
+        }
+    }
+
+    if (!on) {
+        std::fill(samples, samples + frameCount, 0.0f);
+        return;
+    }
+
+    // Plain square wave
+    double step = TONE_FREQUENCY / (double)sampleRate;
+    for (int i = 0; i < frameCount; ++i) {
+        samples[i] = (phase < 0.5) ? amplitude : -amplitude;
+        phase = std::fmod(phase + step, 1.0);
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef AUDIOSDL_H
+#define AUDIOSDL_H
+
+#include <cstdint>
+#include <atomic>
+#include <SDL3/SDL.h>
+
+// Tone generator driven by the CHIP-8 sound timer.
+// Samples are synthesized on SDL's audio thread from a stream callback, so
+// output keeps running even when the render loop stalls. The emulation side
+// only publishes state through atomics and never touches the stream.
+//
+// In master clock mode the callback is not used: the emulator queues the
+// samples for every cycle it runs, and the device's consumption of that queue
+// decides how fast emulation advances (see GetRateAdjustment()).
+class AudioSDL {
+public:
+    AudioSDL();
+    ~AudioSDL();
+
+    // bufferFrames is the device buffer size in sample frames; smaller values
+    // lower output latency at the cost of a higher underrun risk
+    bool Initialize(int sampleRate = 48000, int bufferFrames = 512, bool masterClock = false);
+    void Shutdown();
+
+    bool IsInitialized() const { return stream != nullptr; }
+    bool IsMasterClock() const { return masterClock; }
+    int GetSampleRate() const { return sampleRate; }
+
+    // Emulation side (lock-free)
+    void SetTone(bool on);
+    void SetVolume(float volume);
+
+    // Master clock mode: queue the samples covering one emulated cycle
+    void QueueCycle(double cycleMs);
+    int GetQueuedFrames() const;
+    int GetTargetFrames() const { return targetFrames; }
+    void SetTargetLatency(float milliseconds);
+    // Speed factor for the emulator, nudged by at most MAX_RATE_DEVIATION so
+    // the queue settles around its target fill instead of over/underrunning
+    double GetRateAdjustment() const;
+    uint64_t GetUnderruns() const { return underruns; }
+
+    // Latency reporting
+    float GetBufferLatencyMs() const;
+    float GetLastLatencyMs() const { return lastLatencyUs.load(std::memory_order_relaxed) / 1000.0f; }
+    float GetAverageLatencyMs() const { return averageLatencyUs.load(std::memory_order_relaxed) / 1000.0f; }
+
+private:
+    SDL_AudioStream* stream;
+    int sampleRate;
+    int deviceFrames;
+    bool masterClock;
+
+    // Master clock mode state (emulation thread only)
+    int targetFrames;
+    double fractionalFrames;
+    uint64_t framesQueued;
+    uint64_t underruns;
+
+    // State handed from the emulator to the audio thread
+    std::atomic<bool> toneOn;
+    std::atomic<uint64_t> toneChangedNs;
+    std::atomic<float> volume;
+
+    // Producer-side copy, only touched by the emulation thread
+    bool lastToneOn;
+
+    // Audio thread state
+    double phase;
+    bool playingTone;
+    float samples[1024];
+
+    std::atomic<uint32_t> lastLatencyUs;
+    std::atomic<uint32_t> averageLatencyUs;
+
+    static void SDLCALL AudioCallback(void* userdata, SDL_AudioStream* stream, int additionalAmount, int totalAmount);
+    void Generate(int frameCount);
+};
+
+#endif // AUDIOSDL_H
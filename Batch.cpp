@@ -0,0 +1,246 @@
+// Batch runner: many independent chip8 instances spread over every core on a
+// work-stealing pool. Each ROM is read once and loaded from memory by every
+// job, nothing is logged per job, and all results go into one CSV report.
+#include "chip8.h"
+#include "WorkStealingPool.h"
+#include "LockstepEngine.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <iterator>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+struct BatchJob {
+    std::string rom;
+    uint32_t seed;
+    uint64_t frames;
+    uint16_t keys;                      // Held down for the whole job, bit k = key k
+    const std::vector<uint8_t>* image;  // Shared ROM bytes
+};
+
+struct BatchResult {
+    uint64_t hash;
+    uint64_t cycles;
+    uint64_t frames;        // Frames actually run
+    double wallMs;
+    bool ok;
+};
+
+// Jobs file: one "<rom> <seed> <frames> [keys]" per line, keys a hex mask.
+// Blank lines and lines starting with '#' are ignored.
+static bool LoadJobs(const char* filename, std::vector<BatchJob>& jobs) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open jobs file: " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string rom, seed, frames, keys = "0";
+        if (!(fields >> rom >> seed >> frames)) {
+            std::cerr << filename << ":" << lineNumber << ": expected \"<rom> <seed> <frames> [keys]\"" << std::endl;
+            return false;
+        }
+        fields >> keys;
+
+        try {
+            jobs.push_back({rom, (uint32_t)std::stoul(seed, nullptr, 0), std::stoull(frames),
+                            (uint16_t)std::stoul(keys, nullptr, 16), nullptr});
+        } catch (const std::exception&) {
+            std::cerr << filename << ":" << lineNumber << ": bad number" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool ReadFile(const std::string& filename, std::vector<uint8_t>& data) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static void RunJob(const BatchJob& job, unsigned int cyclesPerFrame, BatchResult& result) {
+    auto start = std::chrono::steady_clock::now();
+
+    chip8 chip8;
+    result.ok = chip8.LoadROM(job.image->data(), job.image->size());
+    chip8.randGen.seed(job.seed);
+    for (int key = 0; key < 16; ++key) {
+        chip8.keypad[key] = (job.keys >> key) & 1;
+    }
+
+    while (result.ok && chip8.frame_count < job.frames) {
+        chip8.emulateFrame(cyclesPerFrame);
+    }
+
+    result.hash = chip8.hashGraphics();
+    result.cycles = chip8.cycle_count;
+    result.frames = chip8.frame_count;
+    result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Jobs sharing a ROM and frame budget run as lanes of one LockstepEngine; wall
+// time is the group's, split evenly over its lanes
+static void RunLockstep(const std::vector<BatchJob>& jobs, const std::vector<size_t>& group,
+                        unsigned int cyclesPerFrame, std::vector<BatchResult>& results) {
+    auto start = std::chrono::steady_clock::now();
+
+    const BatchJob& first = jobs[group[0]];
+    LockstepEngine engine(group.size());
+    bool ok = engine.LoadROM(first.image->data(), first.image->size());
+    for (size_t lane = 0; lane < group.size(); ++lane) {
+        engine.Seed(lane, jobs[group[lane]].seed);
+        engine.SetKeys(lane, jobs[group[lane]].keys);
+    }
+
+    while (ok && engine.GetFrameCount() < first.frames) {
+        engine.RunFrame(cyclesPerFrame);
+    }
+
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    for (size_t lane = 0; lane < group.size(); ++lane) {
+        BatchResult& result = results[group[lane]];
+        result.ok = ok;
+        result.hash = engine.HashGraphics(lane);
+        result.cycles = engine.GetCycleCount();
+        result.frames = engine.GetFrameCount();
+        result.wallMs = wallMs / (double)group.size();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <Jobs> [--threads <n>] [--report <file>] [--cycles-per-frame <n>] [--lockstep <lanes>]\n";
+        std::cerr << "  Jobs: File with one \"<rom> <seed> <frames> [keys]\" job per line, keys a hex mask held down\n";
+        std::cerr << "  --threads: Optional - worker threads (default: all hardware threads)\n";
+        std::cerr << "  --report: Optional - CSV report file (default: stdout)\n";
+        std::cerr << "  --cycles-per-frame: Optional - instructions per frame (default 10)\n";
+        std::cerr << "  --lockstep: Optional - run jobs with the same ROM and frames as lanes of one SoA engine\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    char const* jobsFilename = argv[1];
+    unsigned int threadCount = 0;
+    char const* reportFilename = nullptr;
+    unsigned int cyclesPerFrame = 10;
+    size_t lockstepLanes = 0;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threadCount = (unsigned int)std::stoul(argv[++i]);
+        } else if (arg == "--report" && i + 1 < argc) {
+            reportFilename = argv[++i];
+        } else if (arg == "--cycles-per-frame" && i + 1 < argc) {
+            cyclesPerFrame = (unsigned int)std::stoul(argv[++i]);
+        } else if (arg == "--lockstep" && i + 1 < argc) {
+            lockstepLanes = (size_t)std::stoul(argv[++i]);
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    std::vector<BatchJob> jobs;
+    if (!LoadJobs(jobsFilename, jobs)) {
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Read every distinct ROM once; jobs share the bytes read-only
+    std::map<std::string, std::vector<uint8_t>> images;
+    for (BatchJob& job : jobs) {
+        auto found = images.find(job.rom);
+        if (found == images.end()) {
+            found = images.emplace(job.rom, std::vector<uint8_t>()).first;
+            if (!ReadFile(job.rom, found->second)) {
+                std::cerr << "Failed to open ROM file: " << job.rom << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        job.image = &found->second;
+    }
+
+    // Each job writes only its own slot, so results need no locking
+    std::vector<BatchResult> results(jobs.size());
+    auto start = std::chrono::steady_clock::now();
+    unsigned int threadsUsed;
+    uint64_t steals;
+    {
+        WorkStealingPool pool(threadCount);
+        if (lockstepLanes > 0) {
+            // Group jobs by ROM and frame budget, at most lockstepLanes per group
+            std::map<std::pair<std::string, uint64_t>, std::vector<size_t>> groups;
+            for (size_t i = 0; i < jobs.size(); ++i) {
+                std::vector<size_t>& group = groups[std::make_pair(jobs[i].rom, jobs[i].frames)];
+                group.push_back(i);
+                if (group.size() == lockstepLanes) {
+                    pool.Submit([&, group] { RunLockstep(jobs, group, cyclesPerFrame, results); });
+                    group.clear();
+                }
+            }
+            for (auto& entry : groups) {
+                if (!entry.second.empty()) {
+                    std::vector<size_t> group = entry.second;
+                    pool.Submit([&, group] { RunLockstep(jobs, group, cyclesPerFrame, results); });
+                }
+            }
+        } else {
+            for (size_t i = 0; i < jobs.size(); ++i) {
+                pool.Submit([&, i] { RunJob(jobs[i], cyclesPerFrame, results[i]); });
+            }
+        }
+        pool.Wait();
+        threadsUsed = pool.GetThreadCount();
+        steals = pool.GetStealCount();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream reportFile;
+    if (reportFilename) {
+        reportFile.open(reportFilename);
+        if (!reportFile.is_open()) {
+            std::cerr << "Failed to write report file: " << reportFilename << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    std::ostream& report = reportFilename ? reportFile : std::cout;
+
+    report << "rom,seed,frames,cycles,hash,wall_ms,status\n";
+    uint64_t totalCycles = 0;
+    size_t failures = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const BatchResult& result = results[i];
+        char line[64];
+        std::snprintf(line, sizeof(line), "%016llx,%.3f", (unsigned long long)result.hash, result.wallMs);
+        report << jobs[i].rom << "," << jobs[i].seed << "," << result.frames << "," << result.cycles << ","
+               << line << "," << (result.ok ? "ok" : "error") << "\n";
+        totalCycles += result.cycles;
+        failures += result.ok ? 0 : 1;
+    }
+    report.flush();
+
+    std::cerr << jobs.size() << " jobs on " << threadsUsed << " threads in " << seconds << " s ("
+              << (seconds > 0.0 ? totalCycles / seconds / 1e6 : 0.0) << " M instructions/s, "
+              << steals << " steals)" << std::endl;
+
+    return failures ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,277 @@
+#include "Breakpoints.h"
+#include "chip8.h"
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+Breakpoints::Breakpoints() : breakBits{}, readBits{}, writeBits{}, armed(false) {
+}
+
+void Breakpoints::SetBit(uint64_t* bits, uint16_t address, bool value) {
+    address &= ADDRESS_SPACE - 1;
+    uint64_t mask = 1ULL << (address & 63);
+    if (value) {
+        bits[address >> 6] |= mask;
+    } else {
+        bits[address >> 6] &= ~mask;
+    }
+}
+
+void Breakpoints::UpdateArmed() {
+    armed = false;
+    for (int i = 0; i < WORDS && !armed; ++i) {
+        armed = (breakBits[i] | readBits[i] | writeBits[i]) != 0;
+    }
+}
+
+void Breakpoints::SetBreakpoint(uint16_t address, BreakCondition condition) {
+    SetBit(breakBits, address, true);
+    if (condition) {
+        conditions[address] = std::move(condition);
+    } else {
+        conditions.erase(address);
+    }
+    UpdateArmed();
+}
+
+void Breakpoints::ClearBreakpoint(uint16_t address) {
+    SetBit(breakBits, address, false);
+    conditions.erase(address);
+    UpdateArmed();
+}
+
+void Breakpoints::ToggleBreakpoint(uint16_t address) {
+    if (HasBreakpoint(address)) {
+        ClearBreakpoint(address);
+    } else {
+        SetBreakpoint(address);
+    }
+}
+
+void Breakpoints::SetWatch(uint16_t address, bool onRead, bool onWrite) {
+    SetBit(readBits, address, onRead);
+    SetBit(writeBits, address, onWrite);
+    UpdateArmed();
+}
+
+void Breakpoints::ClearWatch(uint16_t address) {
+    SetWatch(address, false, false);
+}
+
+void Breakpoints::ClearAll() {
+    std::memset(breakBits, 0, sizeof(breakBits));
+    std::memset(readBits, 0, sizeof(readBits));
+    std::memset(writeBits, 0, sizeof(writeBits));
+    conditions.clear();
+    armed = false;
+}
+
+bool Breakpoints::ShouldBreak(const chip8& emulator, uint16_t address) const {
+    if (!HasBreakpoint(address)) {
+        return false;
+    }
+
+    auto it = conditions.find(address & (ADDRESS_SPACE - 1));
+    return it == conditions.end() || it->second(emulator);
+}
+
+// Recursive descent over: expr := and ('||' and)*, and := cmp ('&&' cmp)*,
+// cmp := sum op sum, sum := product (('+'|'-') product)*,
+// product := operand ('*' operand)*. Each node becomes a closure over its children.
+namespace {
+
+typedef ValueExpression Operand;
+
+struct ConditionParser {
+    const std::string& text;
+    size_t pos;
+    std::string error;
+
+    void SkipSpace() {
+        while (pos < text.size() && std::isspace((unsigned char)text[pos])) ++pos;
+    }
+
+    bool Accept(const char* token) {
+        SkipSpace();
+        size_t length = std::strlen(token);
+        if (text.compare(pos, length, token) == 0) {
+            pos += length;
+            return true;
+        }
+        return false;
+    }
+
+    bool ParseNumber(int& value) {
+        SkipSpace();
+        size_t start = pos;
+        int base = 10;
+        if (text.compare(pos, 2, "0x") == 0 || text.compare(pos, 2, "0X") == 0) {
+            base = 16;
+            pos += 2;
+            start = pos;
+        }
+        while (pos < text.size() && (base == 16 ? std::isxdigit((unsigned char)text[pos])
+                                                : std::isdigit((unsigned char)text[pos]))) {
+            ++pos;
+        }
+        if (pos == start) return false;
+        value = std::stoi(text.substr(start, pos - start), nullptr, base);
+        return true;
+    }
+
+    Operand ParseOperand() {
+        SkipSpace();
+        if (pos >= text.size()) {
+            error = "expected operand";
+            return nullptr;
+        }
+
+        char c = (char)std::toupper((unsigned char)text[pos]);
+        if (c == 'V' && pos + 1 < text.size() && std::isxdigit((unsigned char)text[pos + 1])) {
+            int reg = std::stoi(text.substr(pos + 1, 1), nullptr, 16);
+            pos += 2;
+            return [reg](const chip8& e) { return (int)e.registers_V[reg]; };
+        }
+        if (Accept("PC")) return [](const chip8& e) { return (int)e.program_counter; };
+        if (Accept("SP")) return [](const chip8& e) { return (int)e.stack_pointer; };
+        if (Accept("DT")) return [](const chip8& e) { return (int)e.delay_timer; };
+        if (Accept("ST")) return [](const chip8& e) { return (int)e.sound_timer; };
+        if (Accept("I")) return [](const chip8& e) { return (int)e.index_register; };
+        if (Accept("[")) {
+            int address;
+            if (!ParseNumber(address) || !Accept("]")) {
+                error = "expected [address]";
+                return nullptr;
+            }
+            address &= Breakpoints::ADDRESS_SPACE - 1;
+            return [address](const chip8& e) { return (int)e.memory[address]; };
+        }
+
+        int value;
+        if (ParseNumber(value)) {
+            return [value](const chip8&) { return value; };
+        }
+
+        error = "unknown operand at '" + text.substr(pos) + "'";
+        return nullptr;
+    }
+
+    Operand ParseProduct() {
+        Operand result = ParseOperand();
+        while (result && Accept("*")) {
+            Operand rhs = ParseOperand();
+            if (!rhs) return nullptr;
+            result = [lhs = result, rhs](const chip8& e) { return lhs(e) * rhs(e); };
+        }
+        return result;
+    }
+
+    Operand ParseSum() {
+        Operand result = ParseProduct();
+        while (result) {
+            bool add;
+            if (Accept("+")) add = true;
+            else if (Accept("-")) add = false;
+            else break;
+
+            Operand rhs = ParseProduct();
+            if (!rhs) return nullptr;
+            if (add) result = [lhs = result, rhs](const chip8& e) { return lhs(e) + rhs(e); };
+            else result = [lhs = result, rhs](const chip8& e) { return lhs(e) - rhs(e); };
+        }
+        return result;
+    }
+
+    BreakCondition ParseComparison() {
+        Operand lhs = ParseSum();
+        if (!lhs) return nullptr;
+
+        int op;
+        if (Accept("==")) op = 0;
+        else if (Accept("!=")) op = 1;
+        else if (Accept("<=")) op = 2;
+        else if (Accept(">=")) op = 3;
+        else if (Accept("<")) op = 4;
+        else if (Accept(">")) op = 5;
+        else {
+            error = "expected comparison";
+            return nullptr;
+        }
+
+        Operand rhs = ParseSum();
+        if (!rhs) return nullptr;
+
+        switch (op) {
+            case 0: return [lhs, rhs](const chip8& e) { return lhs(e) == rhs(e); };
+            case 1: return [lhs, rhs](const chip8& e) { return lhs(e) != rhs(e); };
+            case 2: return [lhs, rhs](const chip8& e) { return lhs(e) <= rhs(e); };
+            case 3: return [lhs, rhs](const chip8& e) { return lhs(e) >= rhs(e); };
+            case 4: return [lhs, rhs](const chip8& e) { return lhs(e) < rhs(e); };
+            default: return [lhs, rhs](const chip8& e) { return lhs(e) > rhs(e); };
+        }
+    }
+
+    BreakCondition ParseAnd() {
+        BreakCondition result = ParseComparison();
+        while (result && Accept("&&")) {
+            BreakCondition rhs = ParseComparison();
+            if (!rhs) return nullptr;
+            result = [lhs = result, rhs](const chip8& e) { return lhs(e) && rhs(e); };
+        }
+        return result;
+    }
+
+    BreakCondition ParseOr() {
+        BreakCondition result = ParseAnd();
+        while (result && Accept("||")) {
+            BreakCondition rhs = ParseAnd();
+            if (!rhs) return nullptr;
+            result = [lhs = result, rhs](const chip8& e) { return lhs(e) || rhs(e); };
+        }
+        return result;
+    }
+};
+
+}
+
+BreakCondition Breakpoints::CompileCondition(const std::string& text, std::string* error) {
+    ConditionParser parser{text, 0, {}};
+    BreakCondition condition;
+    try {
+        condition = parser.ParseOr();
+    } catch (const std::exception&) {
+        parser.error = "number out of range";
+    }
+
+    parser.SkipSpace();
+    if (condition && parser.pos != text.size()) {
+        parser.error = "unexpected '" + text.substr(parser.pos) + "'";
+        condition = nullptr;
+    }
+
+    if (!condition && error) {
+        *error = parser.error;
+    }
+    return condition;
+}
+
+ValueExpression Breakpoints::CompileExpression(const std::string& text, std::string* error) {
+    ConditionParser parser{text, 0, {}};
+    ValueExpression expression;
+    try {
+        expression = parser.ParseSum();
+    } catch (const std::exception&) {
+        parser.error = "number out of range";
+    }
+
+    parser.SkipSpace();
+    if (expression && parser.pos != text.size()) {
+        parser.error = "unexpected '" + text.substr(parser.pos) + "'";
+        expression = nullptr;
+    }
+
+    if (!expression && error) {
+        *error = parser.error;
+    }
+    return expression;
+}
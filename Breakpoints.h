@@ -0,0 +1,67 @@
+#ifndef BREAKPOINTS_H
+#define BREAKPOINTS_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+class chip8;
+
+// Extra test evaluated when a breakpoint address is reached
+typedef std::function<bool(const chip8&)> BreakCondition;
+typedef std::function<int(const chip8&)> ValueExpression;
+
+// Execution breakpoints and memory watchpoints as one bit per address.
+// chip8 only consults them while IsArmed(); otherwise it runs the plain
+// interpreter with no per-instruction checks at all.
+class Breakpoints {
+public:
+    static const int ADDRESS_SPACE = 4096;
+    static const int WORDS = ADDRESS_SPACE / 64;
+
+    Breakpoints();
+
+    void SetBreakpoint(uint16_t address, BreakCondition condition = nullptr);
+    void ClearBreakpoint(uint16_t address);
+    void ToggleBreakpoint(uint16_t address);
+    void SetWatch(uint16_t address, bool onRead, bool onWrite);
+    void ClearWatch(uint16_t address);
+    void ClearAll();
+
+    bool IsArmed() const { return armed; }
+
+    bool HasBreakpoint(uint16_t address) const { return TestBit(breakBits, address); }
+    bool IsReadWatched(uint16_t address) const { return TestBit(readBits, address); }
+    bool IsWriteWatched(uint16_t address) const { return TestBit(writeBits, address); }
+
+    // True when a breakpoint at address fires for the current state
+    bool ShouldBreak(const chip8& emulator, uint16_t address) const;
+
+    const uint64_t* GetBreakpointBits() const { return breakBits; }
+
+    // Compile an expression such as "V3 == 0x10 && [0x300] != 0" into a
+    // closure. Operands: V0-VF, I, PC, SP, DT, ST, [addr], numbers (0x.. or
+    // decimal), combined with + - *. Comparisons: == != < <= > >=, joined by
+    // && and ||. Returns an empty function and fills error on a syntax error.
+    static BreakCondition CompileCondition(const std::string& text, std::string* error = nullptr);
+
+    // Same syntax without the comparison, e.g. "[0x3F0] * 256 + [0x3F1]"
+    static ValueExpression CompileExpression(const std::string& text, std::string* error = nullptr);
+
+private:
+    uint64_t breakBits[WORDS];
+    uint64_t readBits[WORDS];
+    uint64_t writeBits[WORDS];
+    std::unordered_map<uint16_t, BreakCondition> conditions;
+    bool armed;
+
+    static bool TestBit(const uint64_t* bits, uint16_t address) {
+        address &= ADDRESS_SPACE - 1;
+        return (bits[address >> 6] >> (address & 63)) & 1;
+    }
+    static void SetBit(uint64_t* bits, uint16_t address, bool value);
+    void UpdateArmed();
+};
+
+#endif // BREAKPOINTS_H
@@ -0,0 +1,116 @@
+#include "Cippotto.h"
+#include "chip8.h"
+#include <new>
+
+// No exception may cross the C boundary: allocation failures become NULL or -1
+
+struct cippotto {
+    chip8 emulator;
+    uint32_t seed;
+};
+
+struct cippotto_snapshot {
+    chip8 state;
+};
+
+unsigned int cippotto_abi_version(void) {
+    return CIPPOTTO_ABI_VERSION;
+}
+
+cippotto* cippotto_create(uint32_t seed) {
+    try {
+        cippotto* emu = new cippotto();
+        emu->seed = seed;
+        emu->emulator.randGen.seed(seed);
+        return emu;
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void cippotto_destroy(cippotto* emu) {
+    delete emu;
+}
+
+int cippotto_load_rom(cippotto* emu, const uint8_t* data, size_t size) {
+    try {
+        chip8 fresh;
+        fresh.randGen.seed(emu->seed);
+        if (!fresh.LoadROM(data, size)) {
+            return -1;
+        }
+        emu->emulator = fresh;
+        return 0;
+    } catch (const std::bad_alloc&) {
+        return -1;
+    }
+}
+
+int cippotto_step_instructions(cippotto* emu, uint64_t count) {
+    try {
+        for (uint64_t i = 0; i < count; ++i) {
+            emu->emulator.emulateCycle();
+        }
+        return 0;
+    } catch (const std::bad_alloc&) {
+        return -1;
+    }
+}
+
+int cippotto_step_frames(cippotto* emu, uint64_t count, unsigned int cycles_per_frame) {
+    try {
+        for (uint64_t i = 0; i < count; ++i) {
+            emu->emulator.emulateFrame(cycles_per_frame);
+        }
+        return 0;
+    } catch (const std::bad_alloc&) {
+        return -1;
+    }
+}
+
+void cippotto_set_keys(cippotto* emu, uint16_t mask) {
+    for (int key = 0; key < 16; ++key) {
+        emu->emulator.keypad[key] = (mask >> key) & 1;
+    }
+}
+
+const uint32_t* cippotto_framebuffer(const cippotto* emu) {
+    return emu->emulator.graphics.data();
+}
+
+void cippotto_read_memory(const cippotto* emu, uint16_t address, uint8_t* out, size_t count) {
+    emu->emulator.memory.Read(address, out, count);
+}
+
+uint64_t cippotto_cycle_count(const cippotto* emu) {
+    return emu->emulator.cycle_count;
+}
+
+uint64_t cippotto_frame_count(const cippotto* emu) {
+    return emu->emulator.frame_count;
+}
+
+int cippotto_sound_active(const cippotto* emu) {
+    return emu->emulator.sound_timer > 0;
+}
+
+cippotto_snapshot* cippotto_snapshot_create(const cippotto* emu) {
+    try {
+        return new cippotto_snapshot{emu->emulator.clone()};
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+int cippotto_snapshot_restore(cippotto* emu, const cippotto_snapshot* snapshot) {
+    try {
+        emu->emulator = snapshot->state.clone();
+        return 0;
+    } catch (const std::bad_alloc&) {
+        return -1;
+    }
+}
+
+void cippotto_snapshot_destroy(cippotto_snapshot* snapshot) {
+    delete snapshot;
+}
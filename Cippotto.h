@@ -0,0 +1,88 @@
+#ifndef CIPPOTTO_H
+#define CIPPOTTO_H
+
+/* C interface to the emulator core, for embedding it in other processes and
+ * languages. Only functions and opaque handles cross the boundary, so the
+ * ABI stays the same when the C++ classes behind it change. Functions with a
+ * handle are not thread safe for that handle; separate handles may be used
+ * from separate threads. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(CIPPOTTO_BUILD)
+#    define CIPPOTTO_API __declspec(dllexport)
+#  else
+#    define CIPPOTTO_API __declspec(dllimport)
+#  endif
+#else
+#  define CIPPOTTO_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a signature or the meaning of a function changes */
+#define CIPPOTTO_ABI_VERSION 2
+
+#define CIPPOTTO_SCREEN_WIDTH 64
+#define CIPPOTTO_SCREEN_HEIGHT 32
+
+typedef struct cippotto cippotto;
+typedef struct cippotto_snapshot cippotto_snapshot;
+
+CIPPOTTO_API unsigned int cippotto_abi_version(void);
+
+/* New emulator with an empty program area. seed drives CXNN, so runs with
+ * the same seed and input are repeatable. Returns NULL if out of memory. */
+CIPPOTTO_API cippotto* cippotto_create(uint32_t seed);
+CIPPOTTO_API void cippotto_destroy(cippotto* emu);
+
+/* Reset to power-on state (same seed) and copy the ROM to 0x200.
+ * Returns 0, or -1 if the ROM does not fit (the emulator is left as it was). */
+CIPPOTTO_API int cippotto_load_rom(cippotto* emu, const uint8_t* data, size_t size);
+
+/* Run count instructions; timers tick once per instruction. Writes to memory
+ * shared with a snapshot copy it first, so stepping can run out of memory:
+ * returns 0, or -1 if it did, leaving the emulator part way through an
+ * instruction (restore a snapshot or load the ROM again). */
+CIPPOTTO_API int cippotto_step_instructions(cippotto* emu, uint64_t count);
+
+/* Run count frames of cycles_per_frame instructions each. Returns 0, or -1
+ * as for cippotto_step_instructions(). */
+CIPPOTTO_API int cippotto_step_frames(cippotto* emu, uint64_t count, unsigned int cycles_per_frame);
+
+/* Bit k set = key k down, until the next call */
+CIPPOTTO_API void cippotto_set_keys(cippotto* emu, uint16_t mask);
+
+/* CIPPOTTO_SCREEN_WIDTH * CIPPOTTO_SCREEN_HEIGHT pixels, row major, 0 = off
+ * and 0xFFFFFFFF = on. Points into the emulator itself: it is valid until the
+ * next step, load, restore or destroy on this handle, and must not be written. */
+CIPPOTTO_API const uint32_t* cippotto_framebuffer(const cippotto* emu);
+
+/* Copy count bytes of memory from address (wrapping at 4 KB), e.g. a score */
+CIPPOTTO_API void cippotto_read_memory(const cippotto* emu, uint16_t address, uint8_t* out, size_t count);
+
+CIPPOTTO_API uint64_t cippotto_cycle_count(const cippotto* emu);
+CIPPOTTO_API uint64_t cippotto_frame_count(const cippotto* emu);
+
+/* Nonzero while the sound timer is running */
+CIPPOTTO_API int cippotto_sound_active(const cippotto* emu);
+
+/* Full machine state, including the random generator and keypad. Snapshots
+ * share memory with the emulator copy-on-write, so taking one is cheap.
+ * A snapshot may be restored into handles used on other threads (shared
+ * pages are copied before anything writes them), but must not be destroyed
+ * while a restore from it is running. Returns NULL if out of memory. */
+CIPPOTTO_API cippotto_snapshot* cippotto_snapshot_create(const cippotto* emu);
+/* Returns 0, or -1 if out of memory (the emulator is left as it was) */
+CIPPOTTO_API int cippotto_snapshot_restore(cippotto* emu, const cippotto_snapshot* snapshot);
+CIPPOTTO_API void cippotto_snapshot_destroy(cippotto_snapshot* snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CIPPOTTO_H */
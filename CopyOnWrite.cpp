@@ -0,0 +1,51 @@
+#include "CopyOnWrite.h"
+#include <algorithm>
+#include <cstring>
+
+PagedMemory::PagedMemory() {
+    for (unsigned int page = 0; page < PAGE_COUNT; ++page) {
+        pages[page] = std::make_shared<Page>();
+        bytes[page] = pages[page]->bytes;
+        std::memset(bytes[page], 0, PAGE_SIZE);
+    }
+}
+
+void PagedMemory::Read(unsigned int address, uint8_t* out, size_t count) const {
+    while (count > 0) {
+        address &= SIZE - 1;
+        size_t chunk = std::min<size_t>(count, PAGE_SIZE - address % PAGE_SIZE);
+        std::memcpy(out, bytes[address / PAGE_SIZE] + address % PAGE_SIZE, chunk);
+        address += (unsigned int)chunk;
+        out += chunk;
+        count -= chunk;
+    }
+}
+
+void PagedMemory::Write(unsigned int address, const uint8_t* in, size_t count) {
+    while (count > 0) {
+        address &= SIZE - 1;
+        size_t chunk = std::min<size_t>(count, PAGE_SIZE - address % PAGE_SIZE);
+        std::memcpy(WritablePage(address / PAGE_SIZE) + address % PAGE_SIZE, in, chunk);
+        address += (unsigned int)chunk;
+        in += chunk;
+        count -= chunk;
+    }
+}
+
+void PagedMemory::Fill(uint8_t value) {
+    for (unsigned int page = 0; page < PAGE_COUNT; ++page) {
+        std::memset(WritablePage(page), value, PAGE_SIZE);
+    }
+}
+
+unsigned int PagedMemory::CountSharedPages(const PagedMemory& other) const {
+    unsigned int shared = 0;
+    for (unsigned int page = 0; page < PAGE_COUNT; ++page) {
+        shared += pages[page] == other.pages[page] ? 1 : 0;
+    }
+    return shared;
+}
+
+FrameBuffer::FrameBuffer() : pixels(std::make_shared<Pixels>()) {
+    std::memset(pixels->data, 0, sizeof(pixels->data));
+}
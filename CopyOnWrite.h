@@ -0,0 +1,102 @@
+#ifndef COPYONWRITE_H
+#define COPYONWRITE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+
+// 4 KB address space split into 16 pages of 256 bytes. Copies share every
+// page; a page is duplicated only when a copy that shares it writes to it.
+// Addresses wrap at 4 KB. Copies may live on different threads: a page is
+// written in place only once every other owner has released it.
+class PagedMemory {
+public:
+    static const unsigned int SIZE = 4096;
+    static const unsigned int PAGE_SIZE = 256;
+    static const unsigned int PAGE_COUNT = SIZE / PAGE_SIZE;
+
+    PagedMemory();
+
+    // Reads never copy
+    uint8_t operator[](unsigned int address) const {
+        address &= SIZE - 1;
+        return bytes[address / PAGE_SIZE][address % PAGE_SIZE];
+    }
+
+    // Big-endian word, as instructions are fetched
+    uint16_t Read16(unsigned int address) const {
+        address &= SIZE - 1;
+        if (address % PAGE_SIZE != PAGE_SIZE - 1) {
+            const uint8_t* b = bytes[address / PAGE_SIZE] + address % PAGE_SIZE;
+            return (uint16_t)(b[0] << 8 | b[1]);
+        }
+        return (uint16_t)((*this)[address] << 8 | (*this)[address + 1]);
+    }
+
+    void Write(unsigned int address, uint8_t value) {
+        address &= SIZE - 1;
+        WritablePage(address / PAGE_SIZE)[address % PAGE_SIZE] = value;
+    }
+
+    void Read(unsigned int address, uint8_t* out, size_t count) const;
+    void Write(unsigned int address, const uint8_t* in, size_t count);
+    void Fill(uint8_t value);
+
+    // Pages this memory still shares with other
+    unsigned int CountSharedPages(const PagedMemory& other) const;
+
+private:
+    struct Page {
+        uint8_t bytes[PAGE_SIZE];
+    };
+
+    std::shared_ptr<Page> pages[PAGE_COUNT];
+    uint8_t* bytes[PAGE_COUNT];     // pages[i]->bytes, saves a step on every read
+
+    uint8_t* WritablePage(unsigned int page) {
+        if (pages[page].use_count() != 1) {
+            pages[page] = std::make_shared<Page>(*pages[page]);
+            bytes[page] = pages[page]->bytes;
+        } else {
+            // use_count() is a relaxed load; pair it with the releasing
+            // decrement of an owner on another thread before writing
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return bytes[page];
+    }
+};
+
+// 64x32 framebuffer (one uint32_t per pixel) shared between copies until one
+// of them draws. Converts to a read-only pixel pointer.
+class FrameBuffer {
+public:
+    static const unsigned int PIXELS = 64 * 32;
+
+    FrameBuffer();
+
+    operator const uint32_t*() const { return pixels->data; }
+    const uint32_t* data() const { return pixels->data; }
+
+    // Pixels for writing; duplicates the buffer first if a copy shares it
+    uint32_t* Writable() {
+        if (pixels.use_count() != 1) {
+            pixels = std::make_shared<Pixels>(*pixels);
+        } else {
+            // As in PagedMemory::WritablePage()
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return pixels->data;
+    }
+
+    bool IsSharedWith(const FrameBuffer& other) const { return pixels == other.pixels; }
+
+private:
+    struct Pixels {
+        uint32_t data[PIXELS];
+    };
+
+    std::shared_ptr<Pixels> pixels;
+};
+
+#endif // COPYONWRITE_H
@@ -0,0 +1,129 @@
+#include "CoroutineScheduler.h"
+#include <utility>
+
+namespace {
+
+// co_await PromiseAccess{} hands the coroutine its own promise without suspending
+struct PromiseAccess {
+    Chip8Task::promise_type* promise;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<Chip8Task::promise_type> h) noexcept {
+        promise = &h.promise();
+        return false;
+    }
+    Chip8Task::promise_type& await_resume() const noexcept { return *promise; }
+};
+
+}
+
+Chip8Task& Chip8Task::operator=(Chip8Task&& other) noexcept {
+    if (this != &other) {
+        if (handle) handle.destroy();
+        handle = std::exchange(other.handle, nullptr);
+    }
+    return *this;
+}
+
+Chip8Task::~Chip8Task() {
+    if (handle) {
+        handle.destroy();
+    }
+}
+
+StopReason Chip8Task::Resume(uint64_t budget) {
+    handle.promise().budget = budget;
+    handle.resume();
+    return handle.promise().reason;
+}
+
+Chip8Task RunChip8(chip8& emulator, unsigned int cyclesPerFrame) {
+    Chip8Task::promise_type& promise = co_await PromiseAccess{};
+
+    unsigned int frameCycles = 0;
+    uint64_t ran = 0;           // Instructions since the last resume
+    bool waitingForKey = false;
+
+    for (;;) {
+        if (frameCycles >= cyclesPerFrame) {
+            emulator.endFrame();
+            frameCycles = 0;
+            co_yield StopReason::FrameEnd;
+            ran = 0;
+            continue;
+        }
+        if (promise.budget != 0 && ran >= promise.budget) {
+            co_yield StopReason::Budget;
+            ran = 0;
+            continue;
+        }
+
+        uint16_t pc = emulator.program_counter;
+        bool silent = emulator.sound_timer == 0;
+        emulator.emulateCycle();
+
+        if (emulator.break_reason == BreakReason::Breakpoint) {
+            // Nothing ran; step over the breakpoint once resumed
+            co_yield StopReason::Break;
+            emulator.resumeFromBreak();
+            ran = 0;
+            continue;
+        }
+        ++frameCycles;
+        ++ran;
+
+        if (emulator.break_reason != BreakReason::None) {
+            co_yield StopReason::Break;
+            emulator.break_reason = BreakReason::None;
+            ran = 0;
+            continue;
+        }
+
+        // FX0A without a key rewinds PC to repeat itself
+        uint16_t op = emulator.opcode & 0xF0FF;
+        if (op == 0xF00A && emulator.program_counter == pc) {
+            if (!waitingForKey) {
+                waitingForKey = true;
+                co_yield StopReason::KeyWait;
+                ran = 0;
+            }
+            continue;
+        }
+        waitingForKey = false;
+
+        // Timers tick right after the instruction, so check FX18 itself
+        if (silent && op == 0xF018 && emulator.registers_V[(emulator.opcode >> 8) & 0x0F] != 0) {
+            co_yield StopReason::SoundStart;
+            ran = 0;
+        }
+    }
+}
+
+CoroutineScheduler::CoroutineScheduler(unsigned int cyclesPerFrame, uint64_t slice)
+    : cyclesPerFrame(cyclesPerFrame), slice(slice), activeCount(0), resumeCount(0) {
+}
+
+size_t CoroutineScheduler::Add(chip8& emulator) {
+    instances.push_back({&emulator, RunChip8(emulator, cyclesPerFrame), true});
+    ++activeCount;
+    return instances.size() - 1;
+}
+
+void CoroutineScheduler::Run(const Handler& handler) {
+    while (activeCount > 0) {
+        for (size_t i = 0; i < instances.size(); ++i) {
+            Instance& instance = instances[i];
+            if (!instance.active) {
+                continue;
+            }
+
+            StopReason reason = instance.task.Resume(slice);
+            ++resumeCount;
+            if (!handler(i, *instance.emulator, reason)) {
+                instance.active = false;
+                instance.task = Chip8Task();    // Free the coroutine frame now
+                --activeCount;
+            }
+        }
+    }
+}
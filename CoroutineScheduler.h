@@ -0,0 +1,95 @@
+#ifndef COROUTINESCHEDULER_H
+#define COROUTINESCHEDULER_H
+
+// C++20: built as its own target, the rest of the tree stays C++17
+#include <coroutine>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "chip8.h"
+
+// Why a Chip8Task handed control back
+enum class StopReason : uint8_t {
+    FrameEnd,       // A frame's worth of cycles ran and endFrame() was called
+    KeyWait,        // FX0A started waiting for a key (reported once per wait)
+    SoundStart,     // FX18 started the sound timer from silence
+    Break,          // Breakpoint or watchpoint; see chip8::break_reason
+    Budget          // The instruction budget given to Resume() ran out
+};
+
+// Coroutine that runs one chip8 until the next StopReason and suspends there.
+// It starts suspended and never finishes; destroying the task frees it.
+// Resuming after Break continues past the breakpoint.
+class Chip8Task {
+public:
+    struct promise_type {
+        StopReason reason{};
+        uint64_t budget{};
+
+        Chip8Task get_return_object() { return Chip8Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(StopReason stop) { reason = stop; return {}; }
+        void return_void() {}
+        void unhandled_exception() { throw; }
+    };
+
+    Chip8Task() = default;
+    Chip8Task(Chip8Task&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    Chip8Task& operator=(Chip8Task&& other) noexcept;
+    ~Chip8Task();
+
+    Chip8Task(const Chip8Task&) = delete;
+    Chip8Task& operator=(const Chip8Task&) = delete;
+
+    // Run until the next stop; budget limits the instructions run by this
+    // call (0 = no limit)
+    StopReason Resume(uint64_t budget = 0);
+
+private:
+    explicit Chip8Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Drive emulator in frames of cyclesPerFrame instructions. The emulator must
+// outlive the task.
+Chip8Task RunChip8(chip8& emulator, unsigned int cyclesPerFrame);
+
+// Runs many instances cooperatively on the calling thread: each one in turn
+// runs to its next stop, and the handler decides what happens next (set keys,
+// inspect state, retire it). No threads per instance and no per-instruction
+// calls; an instance costs its chip8 plus a small coroutine frame.
+class CoroutineScheduler {
+public:
+    // Return false to retire the instance
+    typedef std::function<bool(size_t instance, chip8& emulator, StopReason reason)> Handler;
+
+    // slice caps instructions per turn (0 = until the next stop, at most a frame)
+    explicit CoroutineScheduler(unsigned int cyclesPerFrame, uint64_t slice = 0);
+
+    // The emulator must outlive the scheduler; returns the instance number
+    size_t Add(chip8& emulator);
+
+    // Round robin until every instance is retired
+    void Run(const Handler& handler);
+
+    size_t GetActiveCount() const { return activeCount; }
+    uint64_t GetResumeCount() const { return resumeCount; }
+
+private:
+    struct Instance {
+        chip8* emulator;
+        Chip8Task task;
+        bool active;
+    };
+
+    unsigned int cyclesPerFrame;
+    uint64_t slice;
+    std::vector<Instance> instances;
+    size_t activeCount;
+    uint64_t resumeCount;
+};
+
+#endif // COROUTINESCHEDULER_H
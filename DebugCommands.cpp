@@ -0,0 +1,12 @@
+#include "DebugCommands.h"
+
+void DebugCommandQueue::Push(DebugCommandType type, uint16_t address) {
+    std::lock_guard<std::mutex> lock(mutex);
+    commands.push_back({type, address});
+}
+
+void DebugCommandQueue::Drain(std::vector<DebugCommand>& out) {
+    out.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    out.swap(commands);
+}
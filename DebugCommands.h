@@ -0,0 +1,35 @@
+#ifndef DEBUGCOMMANDS_H
+#define DEBUGCOMMANDS_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+enum class DebugCommandType {
+    Pause,
+    Continue,
+    Step,
+    StepBack,
+    ToggleBreakpoint
+};
+
+struct DebugCommand {
+    DebugCommandType type;
+    uint16_t address;   // ToggleBreakpoint only
+};
+
+// Run control requests from the debugger or GDB stub, applied by the emulation
+// loop between cycles so the core never sees a half-applied change
+class DebugCommandQueue {
+public:
+    void Push(DebugCommandType type, uint16_t address = 0);
+
+    // Move everything queued so far into out (cleared first)
+    void Drain(std::vector<DebugCommand>& out);
+
+private:
+    std::mutex mutex;
+    std::vector<DebugCommand> commands;
+};
+
+#endif // DEBUGCOMMANDS_H
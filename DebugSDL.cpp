@@ -1,13 +1,23 @@
 #include "DebugSDL.h"
 #include <iostream>
-#include <sstream>
-#include <iomanip>
 #include <cstdarg>
+#include <cstdio>
 #include <algorithm>
+#include <cmath>
+
+// Snapshots over which a changed memory byte fades back to the normal colour
+const int MEMORY_FADE_STEPS = 30;
+
+// Fraction of memory access heat kept from one snapshot to the next
+const float HEAT_DECAY = 0.85f;
 
 DebugSDL::DebugSDL() 
     : window(nullptr), renderer(nullptr), font(nullptr), smallFont(nullptr),
-      enabled(false), initialized(false), chip8Ptr(nullptr),
+      displayTexture(nullptr), displayWidth(VIDEO_WIDTH), displayHeight(VIDEO_HEIGHT),
+      displayArea{}, mouseX(-1.0f), mouseY(-1.0f),
+      showHeatMap(false), heatTexture(nullptr), readHeat{}, writeHeat{}, lastReads{}, lastWrites{},
+      enabled(false), initialized(false), needsRedraw(true), state(nullptr), renderedSequence(0),
+      closeRequested(false), windowID(0), snapshotSource(nullptr), commandQueue(nullptr), framePeriod(33333),
       windowWidth(1200), windowHeight(800), fontSize(16), lineHeight(20),
       sectionPadding(10), columnWidth(280) {
 
@@ -27,8 +37,61 @@ DebugSDL::DebugSDL()
 }
 
 DebugSDL::~DebugSDL() {
+    Stop();
     Shutdown();
 }
+
+bool DebugSDL::Start(const char* title, int width, int height, SnapshotBuffer& snapshots,
+                     DebugCommandQueue* commands, int refreshHz) {
+    snapshotSource = &snapshots;
+    commandQueue = commands;
+    framePeriod = std::chrono::microseconds(1000000 / std::max(refreshHz, 1));
+    nextFrameTime = std::chrono::steady_clock::now();
+    closeRequested = false;
+
+    if (!Initialize(title, width, height)) {
+        Shutdown();
+        return false;
+    }
+    windowID = SDL_GetWindowID(window);
+    return true;
+}
+
+void DebugSDL::Stop() {
+    windowID = 0;
+}
+
+void DebugSDL::Tick() {
+    auto now = std::chrono::steady_clock::now();
+    if (initialized && now >= nextFrameTime) {
+        RunFrame();
+        // Fell behind: don't try to catch up
+        nextFrameTime = std::max(nextFrameTime + framePeriod, now);
+    }
+}
+
+void DebugSDL::PostEvent(const SDL_Event& e) {
+    pendingEvents.push_back(e);
+}
+
+void DebugSDL::RunFrame() {
+    processingEvents.swap(pendingEvents);
+
+    for (const SDL_Event& e : processingEvents) {
+        if (HandleEvent(e)) {
+            closeRequested = true;
+        }
+    }
+    processingEvents.clear();
+
+    if (snapshotSource) {
+        if (const Chip8Snapshot* snapshot = snapshotSource->Acquire()) {
+            Update(snapshot);
+        }
+    }
+
+    Render();
+}
 bool DebugSDL::Initialize(const char* title, int width, int height) {
     windowWidth = width;
     windowHeight = height;
@@ -70,6 +133,25 @@ bool DebugSDL::Initialize(const char* title, int width, int height) {
 }
 
 void DebugSDL::Shutdown() {
+    ReleasePanelCache(registersSection);
+    ReleasePanelCache(memorySection);
+    ReleasePanelCache(stackSection);
+    ReleasePanelCache(disassemblySection);
+    ReleasePanelCache(keypadSection);
+    ReleasePanelCache(graphicsSection);
+
+    if (displayTexture) {
+        SDL_DestroyTexture(displayTexture);
+        displayTexture = nullptr;
+    }
+
+    if (heatTexture) {
+        SDL_DestroyTexture(heatTexture);
+        heatTexture = nullptr;
+    }
+
+    glyphAtlas.Destroy();
+
     if (font) {
         TTF_CloseFont(font);
         font = nullptr;
@@ -149,6 +231,11 @@ bool DebugSDL::InitializeFonts() {
         smallFont = font; // Use same font if smaller version fails
     }
 
+    // Rasterise the glyphs once; text is then drawn as batched quads
+    if (!glyphAtlas.Build(renderer, font)) {
+        std::cerr << "Failed to build glyph atlas, debugger text disabled" << std::endl;
+    }
+
     return true;
 }
 
@@ -164,6 +251,7 @@ void DebugSDL::SetupColors() {
     borderColor = {80, 80, 90, 255};
     pcColor = {255, 100, 100, 255};
     activeColor = {100, 255, 100, 255};
+    breakpointColor = {255, 80, 200, 255};
 }
 
 // Add these helper functions to the DebugSDL class
@@ -215,18 +303,18 @@ void DebugSDL::CalculateLayout() {
     float currentY = padding;
 
     // Registers section
-    float registersHeight = std::max((float)lineHeight * 12.0f + padding, 150.0f);
-    registersSection = {{leftX, currentY, leftColumnWidth, registersHeight}, "Registers & State", true, false};
+    float registersHeight = std::max((float)lineHeight * 13.0f + padding, 150.0f);
+    SetSectionLayout(registersSection, {leftX, currentY, leftColumnWidth, registersHeight}, "Registers & State");
     currentY += registersHeight + padding;
 
     // Keypad section
     float keypadHeight = std::max((float)lineHeight * 8.0f + padding, 180.0f);
-    keypadSection = {{leftX, currentY, leftColumnWidth, keypadHeight}, "Keypad", true, false};
+    SetSectionLayout(keypadSection, {leftX, currentY, leftColumnWidth, keypadHeight}, "Keypad");
     currentY += keypadHeight + padding;
 
     // Stack section
     float stackHeight = std::max(totalHeight - currentY - padding, 100.0f);
-    stackSection = {{leftX, currentY, leftColumnWidth, stackHeight}, "Stack", true, false};
+    SetSectionLayout(stackSection, {leftX, currentY, leftColumnWidth, stackHeight}, "Stack");
 
     // Middle column sections
     float middleX = leftX + leftColumnWidth + padding;
@@ -234,80 +322,320 @@ void DebugSDL::CalculateLayout() {
 
     // Memory section
     float memoryHeight = std::max(availableHeight * 0.6f, 200.0f);
-    memorySection = {{middleX, currentY, middleColumnWidth, memoryHeight}, "Memory View", true, false};
+    SetSectionLayout(memorySection, {middleX, currentY, middleColumnWidth, memoryHeight}, "Memory View");
     currentY += memoryHeight + padding;
 
     // Disassembly section
     float disassemblyHeight = std::max(totalHeight - currentY - padding, 150.0f);
-    disassemblySection = {{middleX, currentY, middleColumnWidth, disassemblyHeight}, "Disassembly", true, false};
+    SetSectionLayout(disassemblySection, {middleX, currentY, middleColumnWidth, disassemblyHeight}, "Disassembly");
 
     // Right column
     float rightX = middleX + middleColumnWidth + padding;
-    graphicsSection = {{rightX, padding, rightColumnWidth, availableHeight}, "Graphics Display", true, false};
+    SetSectionLayout(graphicsSection, {rightX, padding, rightColumnWidth, availableHeight}, "Graphics Display");
 
     // Enforce minimum sizes
     EnforceMinimumSizes();
+
+    needsRedraw = true;
+}
+
+void DebugSDL::SetSectionLayout(DebugSection& section, const SDL_FRect& rect, const char* title) {
+    section.rect = rect;
+    section.title = title;
 }
 
 
-void DebugSDL::Update(chip8* emulator) {
+void DebugSDL::Update(const Chip8Snapshot* snapshot) {
     if (!enabled || !initialized) return;
 
-    chip8Ptr = emulator;
+    state = snapshot;
 
     // Update memory view to follow PC if enabled
-    if (memoryView.followPC && chip8Ptr) {
-        uint16_t pc = chip8Ptr->program_counter;
+    if (memoryView.followPC && state) {
+        uint16_t pc = state->program_counter;
         memoryView.startAddress = (pc >= 32) ? pc - 32 : 0;
         memoryView.endAddress = std::min(4096, (int)(pc + 64));
     }
 
     // Update disassembly view
-    if (disassemblyView.followPC && chip8Ptr) {
-        disassemblyView.currentAddress = chip8Ptr->program_counter;
+    if (disassemblyView.followPC && state) {
+        disassemblyView.currentAddress = state->program_counter;
     }
 }
 
 void DebugSDL::Render() {
-    if (!enabled || !initialized || !chip8Ptr) return;
+    if (!enabled || !initialized || !state) return;
+
+    // No new emulator state and nothing changed on the debugger side
+    bool newSnapshot = state->sequence != renderedSequence;
+    if (!needsRedraw && !newSnapshot) return;
+    renderedSequence = state->sequence;
+
+    // Drop cached disassembly for bytes written since the last snapshot, and
+    // age changes and heat. Only once per snapshot: redraws for input or mouse
+    // moves must not.
+    if (newSnapshot) {
+        disassemblyCache.Sync(state->memory);
+        memoryDiff.Update(state->memory);
+        UpdateHeat();
+
+        // The graphics panel follows the emulator's display size
+        if (state->display_width != displayWidth || state->display_height != displayHeight) {
+            displayWidth = state->display_width;
+            displayHeight = state->display_height;
+            graphicsSection.cacheValid = false;
+        }
+    }
+
+    uint64_t registersHash = HashRegisters();
+    uint64_t memoryHash = HashMemoryView();
+    uint64_t stackHash = HashStack();
+    uint64_t disassemblyHash = HashDisassembly();
+    uint64_t keypadHash = HashKeypad();
+    uint64_t graphicsHash = HashGraphics();
+
+    auto stale = [](const DebugSection& section, uint64_t hash) {
+        return section.visible && (!section.cacheValid || section.contentHash != hash);
+    };
+
+    // Nothing to do when no panel's state changed since the last present
+    if (!needsRedraw && !stale(registersSection, registersHash) && !stale(memorySection, memoryHash) &&
+        !stale(stackSection, stackHash) && !stale(disassemblySection, disassemblyHash) &&
+        !stale(keypadSection, keypadHash) && !stale(graphicsSection, graphicsHash)) {
+        return;
+    }
 
     RenderBackground();
 
-    if (registersSection.visible) RenderRegisters();
-    if (memorySection.visible) RenderMemory();
-    if (stackSection.visible) RenderStack();
-    if (disassemblySection.visible) RenderDisassembly();
-    if (keypadSection.visible) RenderKeypad();
-    if (graphicsSection.visible) RenderGraphics();
+    if (registersSection.visible) RenderPanel(registersSection, registersHash, &DebugSDL::RenderRegisters);
+    if (memorySection.visible) RenderPanel(memorySection, memoryHash, &DebugSDL::RenderMemory);
+    if (stackSection.visible) RenderPanel(stackSection, stackHash, &DebugSDL::RenderStack);
+    if (disassemblySection.visible) RenderPanel(disassemblySection, disassemblyHash, &DebugSDL::RenderDisassembly);
+    if (keypadSection.visible) RenderPanel(keypadSection, keypadHash, &DebugSDL::RenderKeypad);
+    if (graphicsSection.visible) {
+        RenderPanel(graphicsSection, graphicsHash, showHeatMap ? &DebugSDL::RenderHeatMap : &DebugSDL::RenderGraphics);
+    }
+
+    // Anything drawn straight to the window goes out in a single geometry call
+    glyphAtlas.Flush();
 
     SDL_RenderPresent(renderer);
+    needsRedraw = false;
 }
 
-bool DebugSDL::HandleEvents() {
-    if (!enabled || !initialized) return false;
+void DebugSDL::RenderPanel(DebugSection& section, uint64_t stateHash, PanelRenderer draw) {
+    int width = (int)section.rect.w;
+    int height = (int)section.rect.h;
+
+    if (section.cache && (section.cacheWidth != width || section.cacheHeight != height)) {
+        ReleasePanelCache(section);
+    }
 
-    SDL_Event e;
-    while (SDL_PollEvent(&e)) {
-        switch (e.type) {
-            case SDL_EVENT_QUIT:
-                return true;
+    if (!section.cache) {
+        section.cache = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!section.cache) {
+            // No render targets available: draw the panel directly every frame
+            (this->*draw)(section.rect);
+            return;
+        }
+        section.cacheWidth = width;
+        section.cacheHeight = height;
+        section.cacheValid = false;
+    }
 
-            case SDL_EVENT_KEY_DOWN:
-                HandleKeyPress(e.key.key);
-                break;
+    if (!section.cacheValid || section.contentHash != stateHash) {
+        SDL_SetRenderTarget(renderer, section.cache);
 
-            case SDL_EVENT_MOUSE_BUTTON_DOWN:
-                if (e.button.button == SDL_BUTTON_LEFT) {
-                    HandleMouseClick((float)e.button.x, (float)e.button.y);
-                }
-                break;
+        // Start from the window background so the cached panel is opaque and
+        // looks exactly like one drawn straight to the window
+        SDL_SetRenderDrawColor(renderer, bgColor.r, bgColor.g, bgColor.b, 255);
+        SDL_RenderClear(renderer);
+
+        (this->*draw)({0.0f, 0.0f, (float)width, (float)height});
+        glyphAtlas.Flush();
+
+        SDL_SetRenderTarget(renderer, nullptr);
+        section.contentHash = stateHash;
+        section.cacheValid = true;
+    }
+
+    SDL_FRect dest = {section.rect.x, section.rect.y, (float)width, (float)height};
+    SDL_RenderTexture(renderer, section.cache, nullptr, &dest);
+}
+
+void DebugSDL::ReleasePanelCache(DebugSection& section) {
+    if (section.cache) {
+        SDL_DestroyTexture(section.cache);
+        section.cache = nullptr;
+    }
+    section.cacheWidth = 0;
+    section.cacheHeight = 0;
+    section.cacheValid = false;
+}
+
+// FNV-1a, enough to tell whether a panel's inputs changed
+static uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
 
-            case SDL_EVENT_WINDOW_RESIZED:
-                windowWidth = e.window.data1;
-                windowHeight = e.window.data2;
-                CalculateLayout();
-                break;
+uint64_t DebugSDL::HashRegisters() const {
+    if (!state) return 0;
+
+    uint64_t hash = HashBytes(state->registers_V, sizeof(state->registers_V));
+    hash = HashBytes(&state->program_counter, sizeof(state->program_counter), hash);
+    hash = HashBytes(&state->index_register, sizeof(state->index_register), hash);
+    hash = HashBytes(&state->stack_pointer, sizeof(state->stack_pointer), hash);
+    hash = HashBytes(&state->opcode, sizeof(state->opcode), hash);
+    hash = HashBytes(&state->delay_timer, sizeof(state->delay_timer), hash);
+    hash = HashBytes(&state->sound_timer, sizeof(state->sound_timer), hash);
+    hash = HashBytes(&state->paused, sizeof(state->paused), hash);
+    hash = HashBytes(&state->break_reason, sizeof(state->break_reason), hash);
+    return HashBytes(&state->break_address, sizeof(state->break_address), hash);
+}
+
+uint64_t DebugSDL::HashMemoryView() const {
+    if (!state) return 0;
+
+    uint16_t start = memoryView.startAddress;
+    uint16_t end = std::min((int)memoryView.endAddress, 4096);
+    uint64_t hash = HashBytes(&memoryView.startAddress, sizeof(memoryView.startAddress));
+    hash = HashBytes(&memoryView.endAddress, sizeof(memoryView.endAddress), hash);
+    hash = HashBytes(&memoryView.bytesPerRow, sizeof(memoryView.bytesPerRow), hash);
+    hash = HashBytes(&memoryView.showAscii, sizeof(memoryView.showAscii), hash);
+    hash = HashBytes(&state->program_counter, sizeof(state->program_counter), hash);
+
+    // Fading highlights and the change list redraw the panel too
+    const std::vector<uint16_t>& changed = memoryDiff.GetChanged();
+    hash = HashBytes(changed.data(), changed.size() * sizeof(uint16_t), hash);
+    if (end > start) {
+        hash = HashBytes(memoryDiff.GetAges() + start, end - start, hash);
+        hash = HashBytes(state->memory + start, end - start, hash);
+    }
+    return hash;
+}
+
+uint64_t DebugSDL::HashStack() const {
+    if (!state) return 0;
+
+    uint64_t hash = HashBytes(&state->stack_pointer, sizeof(state->stack_pointer));
+    return HashBytes(state->stack, sizeof(state->stack), hash);
+}
+
+uint64_t DebugSDL::HashDisassembly() const {
+    if (!state) return 0;
+
+    // Same window RenderDisassembly shows
+    uint16_t pc = state->program_counter;
+    uint16_t start = GetDisassemblyStart();
+    uint16_t end = std::min(4096, start + disassemblyView.instructionsToShow * 2);
+    uint64_t hash = HashBytes(&pc, sizeof(pc));
+    hash = HashBytes(state->breakpointBits, sizeof(state->breakpointBits), hash);
+    return (end > start) ? HashBytes(state->memory + start, end - start, hash) : hash;
+}
+
+uint64_t DebugSDL::HashKeypad() const {
+    if (!state) return 0;
+    return HashBytes(state->keypad, sizeof(state->keypad));
+}
+
+uint64_t DebugSDL::HashGraphics() const {
+    if (!state) return 0;
+
+    // The heat map cools down every snapshot, so it changes whenever they do
+    if (showHeatMap) {
+        uint64_t hash = HashBytes(&showHeatMap, sizeof(showHeatMap));
+        return HashBytes(&state->sequence, sizeof(state->sequence), hash);
+    }
+    uint64_t hash = HashBytes(state->graphics, (size_t)displayWidth * displayHeight * sizeof(uint32_t));
+
+    if (state->has_pixel_origins) {
+        int hovered = GetHoveredPixel();
+        hash = HashBytes(&hovered, sizeof(hovered), hash);
+        if (hovered >= 0) {
+            hash = HashBytes(&state->pixel_origins[hovered], sizeof(PixelOrigin), hash);
+        }
+    }
+    return hash;
+}
+
+SDL_Color DebugSDL::GetChangeColor(uint8_t age, SDL_Color base) const {
+    if (age >= MEMORY_FADE_STEPS) {
+        return base;
+    }
+
+    // Blend from the highlight colour towards base as the change ages
+    float t = (float)age / (float)MEMORY_FADE_STEPS;
+    return {
+        (Uint8)(highlightColor.r + (base.r - highlightColor.r) * t),
+        (Uint8)(highlightColor.g + (base.g - highlightColor.g) * t),
+        (Uint8)(highlightColor.b + (base.b - highlightColor.b) * t),
+        255
+    };
+}
+
+uint16_t DebugSDL::GetDisassemblyStart() const {
+    uint16_t pc = state ? state->program_counter : 0x200;
+    return (pc >= 20) ? pc - 20 : 0x200;
+}
+
+bool DebugSDL::HasBreakpoint(uint16_t address) const {
+    address &= Breakpoints::ADDRESS_SPACE - 1;
+    return state && ((state->breakpointBits[address >> 6] >> (address & 63)) & 1);
+}
+
+void DebugSDL::SendCommand(DebugCommandType type, uint16_t address) {
+    if (commandQueue) {
+        commandQueue->Push(type, address);
+    }
+}
+
+bool DebugSDL::HandleEvent(const SDL_Event& e) {
+    if (!initialized) return false;
+
+    if (e.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED) {
+        return true;
+    }
+
+    if (!enabled) return false;
+
+    switch (e.type) {
+        case SDL_EVENT_KEY_DOWN:
+            HandleKeyPress(e.key.key);
+            needsRedraw = true;
+            break;
+
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+            if (e.button.button == SDL_BUTTON_LEFT) {
+                HandleMouseClick((float)e.button.x, (float)e.button.y);
+                needsRedraw = true;
+            }
+            break;
+
+        case SDL_EVENT_MOUSE_MOTION: {
+            // Only the provenance readout depends on the mouse position
+            int previous = GetHoveredPixel();
+            mouseX = e.motion.x;
+            mouseY = e.motion.y;
+            if (GetHoveredPixel() != previous) {
+                needsRedraw = true;
+            }
+            break;
         }
+
+        case SDL_EVENT_WINDOW_EXPOSED:
+            needsRedraw = true;
+            break;
+
+        case SDL_EVENT_WINDOW_RESIZED:
+            windowWidth = e.window.data1;
+            windowHeight = e.window.data2;
+            CalculateLayout();
+            break;
     }
 
     return false;
@@ -318,45 +646,62 @@ void DebugSDL::RenderBackground() {
     SDL_RenderClear(renderer);
 }
 
-void DebugSDL::RenderSection(const DebugSection& section) {
+void DebugSDL::RenderSection(const SDL_FRect& rect) {
     // Draw section border
     SDL_SetRenderDrawColor(renderer, borderColor.r, borderColor.g, borderColor.b, borderColor.a);
-    SDL_FRect borderRect = section.rect;
+    SDL_FRect borderRect = rect;
     SDL_RenderRect(renderer, &borderRect);
 
     // Draw section background
     SDL_SetRenderDrawColor(renderer, bgColor.r + 10, bgColor.g + 10, bgColor.b + 10, 200);
-    SDL_FRect fillRect = {section.rect.x + 1.0f, section.rect.y + 1.0f, section.rect.w - 2.0f, section.rect.h - 2.0f};
+    SDL_FRect fillRect = {rect.x + 1.0f, rect.y + 1.0f, rect.w - 2.0f, rect.h - 2.0f};
     SDL_RenderFillRect(renderer, &fillRect);
 }
 
-void DebugSDL::RenderRegisters() {
-    if (!chip8Ptr) return;
+void DebugSDL::RenderRegisters(const SDL_FRect& rect) {
+    if (!state) return;
 
-    RenderSection(registersSection);
+    RenderSection(rect);
 
-    float x = registersSection.rect.x + 5.0f;
-    float y = registersSection.rect.y + 5.0f;
+    float x = rect.x + 5.0f;
+    float y = rect.y + 5.0f;
 
     // Section header
-    SDL_FRect headerRect = RenderSectionHeader("Registers & State", x, y, registersSection.rect.w - 10.0f);
+    SDL_FRect headerRect = RenderSectionHeader("Registers & State", x, y, rect.w - 10.0f);
     y += headerRect.h + 5.0f;
 
+    // Run state
+    switch (state->break_reason) {
+        case BreakReason::Breakpoint:
+            RenderTextF(x, y, breakpointColor, "BREAK: breakpoint at 0x%04X", state->break_address);
+            break;
+        case BreakReason::ReadWatch:
+            RenderTextF(x, y, breakpointColor, "BREAK: read of 0x%04X", state->break_address);
+            break;
+        case BreakReason::WriteWatch:
+            RenderTextF(x, y, breakpointColor, "BREAK: write to 0x%04X", state->break_address);
+            break;
+        default:
+            RenderText(state->paused ? "PAUSED" : "RUNNING", x, y, state->paused ? highlightColor : activeColor);
+            break;
+    }
+    y += (float)lineHeight;
+
     // Program Counter
-    RenderTextF(x, y, (chip8Ptr->program_counter >= 0x200) ? textColor : pcColor,
-                "PC: 0x%04X", chip8Ptr->program_counter);
+    RenderTextF(x, y, (state->program_counter >= 0x200) ? textColor : pcColor,
+                "PC: 0x%04X", state->program_counter);
     y += (float)lineHeight;
 
     // Index Register
-    RenderTextF(x, y, textColor, "I:  0x%04X", chip8Ptr->index_register);
+    RenderTextF(x, y, textColor, "I:  0x%04X", state->index_register);
     y += (float)lineHeight;
 
     // Stack Pointer
-    RenderTextF(x, y, textColor, "SP: %02X", chip8Ptr->stack_pointer);
+    RenderTextF(x, y, textColor, "SP: %02X", state->stack_pointer);
     y += (float)lineHeight;
 
     // Current Opcode
-    RenderTextF(x, y, highlightColor, "OP: 0x%04X", chip8Ptr->opcode);
+    RenderTextF(x, y, highlightColor, "OP: 0x%04X", state->opcode);
     y += (float)lineHeight * 1.5f;
 
     // Registers V0-VF
@@ -365,10 +710,10 @@ void DebugSDL::RenderRegisters() {
 
     for (int i = 0; i < 16; i += 4) {
         RenderTextF(x, y, textColor, "V%X:%02X V%X:%02X V%X:%02X V%X:%02X",
-                   i, chip8Ptr->registers_V[i],
-                   i+1, chip8Ptr->registers_V[i+1],
-                   i+2, chip8Ptr->registers_V[i+2],
-                   i+3, chip8Ptr->registers_V[i+3]);
+                   i, state->registers_V[i],
+                   i+1, state->registers_V[i+1],
+                   i+2, state->registers_V[i+2],
+                   i+3, state->registers_V[i+3]);
         y += (float)lineHeight;
     }
 
@@ -378,30 +723,48 @@ void DebugSDL::RenderRegisters() {
     RenderText("Timers:", x, y, headerColor);
     y += (float)lineHeight;
 
-    RenderTextF(x, y, (chip8Ptr->delay_timer > 0) ? activeColor : textColor,
-                "Delay: %02X", chip8Ptr->delay_timer);
+    RenderTextF(x, y, (state->delay_timer > 0) ? activeColor : textColor,
+                "Delay: %02X", state->delay_timer);
     y += (float)lineHeight;
 
-    RenderTextF(x, y, (chip8Ptr->sound_timer > 0) ? activeColor : textColor,
-                "Sound: %02X", chip8Ptr->sound_timer);
+    RenderTextF(x, y, (state->sound_timer > 0) ? activeColor : textColor,
+                "Sound: %02X", state->sound_timer);
 }
 
-void DebugSDL::RenderMemory() {
-    if (!chip8Ptr) return;
+void DebugSDL::RenderMemory(const SDL_FRect& rect) {
+    if (!state) return;
 
-    RenderSection(memorySection);
+    RenderSection(rect);
 
-    float x = memorySection.rect.x + 5.0f;
-    float y = memorySection.rect.y + 5.0f;
+    float x = rect.x + 5.0f;
+    float y = rect.y + 5.0f;
 
     // Section header
-    SDL_FRect headerRect = RenderSectionHeader("Memory View", x, y, memorySection.rect.w - 10.0f);
+    SDL_FRect headerRect = RenderSectionHeader("Memory View", x, y, rect.w - 10.0f);
     y += headerRect.h + 5.0f;
 
-    uint16_t pc = chip8Ptr->program_counter;
+    uint16_t pc = state->program_counter;
     uint16_t start = memoryView.startAddress;
     uint16_t end = std::min((int)memoryView.endAddress, 4096);
 
+    // Addresses written since the previous snapshot
+    const std::vector<uint16_t>& changed = memoryDiff.GetChanged();
+    if (!changed.empty()) {
+        char list[128];
+        int length = snprintf(list, sizeof(list), "Changed:");
+        size_t shown = 0;
+        for (; shown < changed.size() && length < (int)sizeof(list) - 16; ++shown) {
+            length += snprintf(list + length, sizeof(list) - length, " %03X", changed[shown]);
+        }
+        if (shown < changed.size()) {
+            snprintf(list + length, sizeof(list) - length, " +%d", (int)(changed.size() - shown));
+        }
+        RenderText(list, x, y, highlightColor);
+    } else {
+        RenderText("Changed: none", x, y, textColor);
+    }
+    y += (float)lineHeight;
+
     for (uint16_t addr = start; addr < end; addr += memoryView.bytesPerRow) {
         SDL_Color addrColor = (addr == pc || addr == pc - 2) ? pcColor : textColor;
 
@@ -411,8 +774,9 @@ void DebugSDL::RenderMemory() {
         // Hex bytes
         float hexX = x + 50.0f;
         for (int i = 0; i < memoryView.bytesPerRow && addr + i < end; i++) {
-            uint8_t byte = chip8Ptr->memory[addr + i];
-            SDL_Color byteColor = (addr + i == pc || addr + i == pc + 1) ? pcColor : textColor;
+            uint8_t byte = state->memory[addr + i];
+            SDL_Color byteColor = (addr + i == pc || addr + i == pc + 1) ? pcColor
+                                  : GetChangeColor(memoryDiff.GetAge(addr + i), textColor);
 
             RenderTextF(hexX + (float)i * 24.0f, y, byteColor, "%02X", byte);
         }
@@ -420,108 +784,110 @@ void DebugSDL::RenderMemory() {
         // ASCII representation
         if (memoryView.showAscii) {
             float asciiX = hexX + (float)memoryView.bytesPerRow * 24.0f + 10.0f;
-            std::string ascii = "";
-            for (int i = 0; i < memoryView.bytesPerRow && addr + i < end; i++) {
-                uint8_t byte = chip8Ptr->memory[addr + i];
-                ascii += (byte >= 32 && byte <= 126) ? (char)byte : '.';
+            char ascii[65];
+            int count = 0;
+            for (int i = 0; i < memoryView.bytesPerRow && addr + i < end && count < 64; i++) {
+                uint8_t byte = state->memory[addr + i];
+                ascii[count++] = (byte >= 32 && byte <= 126) ? (char)byte : '.';
             }
+            ascii[count] = '\0';
             RenderText(ascii, asciiX, y, textColor);
         }
 
         y += (float)lineHeight;
 
         // Don't overflow the section
-        if (y > memorySection.rect.y + memorySection.rect.h - (float)lineHeight) {
+        if (y > rect.y + rect.h - (float)lineHeight) {
             break;
         }
     }
 }
 
-void DebugSDL::RenderStack() {
-    if (!chip8Ptr) return;
+void DebugSDL::RenderStack(const SDL_FRect& rect) {
+    if (!state) return;
 
-    RenderSection(stackSection);
+    RenderSection(rect);
 
-    float x = stackSection.rect.x + 5.0f;
-    float y = stackSection.rect.y + 5.0f;
+    float x = rect.x + 5.0f;
+    float y = rect.y + 5.0f;
 
     // Section header
-    SDL_FRect headerRect = RenderSectionHeader("Stack", x, y, stackSection.rect.w - 10.0f);
+    SDL_FRect headerRect = RenderSectionHeader("Stack", x, y, rect.w - 10.0f);
     y += headerRect.h + 5.0f;
 
-    RenderTextF(x, y, textColor, "Stack Pointer: %d", chip8Ptr->stack_pointer);
+    RenderTextF(x, y, textColor, "Stack Pointer: %d", state->stack_pointer);
     y += (float)lineHeight * 1.5f;
 
     // Show stack entries
-    int startIdx = std::max(0, (int)chip8Ptr->stack_pointer - 8);
-    int endIdx = std::min(16, (int)chip8Ptr->stack_pointer + 2);
+    int startIdx = std::max(0, (int)state->stack_pointer - 8);
+    int endIdx = std::min(16, (int)state->stack_pointer + 2);
 
     for (int i = endIdx - 1; i >= startIdx; i--) {
         SDL_Color stackColor = textColor;
-        std::string prefix = "    ";
+        const char* prefix = "    ";
 
-        if (i == chip8Ptr->stack_pointer - 1 && chip8Ptr->stack_pointer > 0) {
+        if (i == state->stack_pointer - 1 && state->stack_pointer > 0) {
             stackColor = activeColor;
             prefix = " -> ";
-        } else if (i >= chip8Ptr->stack_pointer) {
+        } else if (i >= state->stack_pointer) {
             stackColor = {100, 100, 100, 255};  // Dimmed for empty slots
         }
 
-        if (i < chip8Ptr->stack_pointer) {
-            RenderTextF(x, y, stackColor, "%s[%02d]: 0x%04X", prefix.c_str(), i, chip8Ptr->stack[i]);
+        if (i < state->stack_pointer) {
+            RenderTextF(x, y, stackColor, "%s[%02d]: 0x%04X", prefix, i, state->stack[i]);
         } else {
-            RenderTextF(x, y, stackColor, "%s[%02d]: ----", prefix.c_str(), i);
+            RenderTextF(x, y, stackColor, "%s[%02d]: ----", prefix, i);
         }
 
         y += (float)lineHeight;
     }
 }
 
-void DebugSDL::RenderDisassembly() {
-    if (!chip8Ptr) return;
+void DebugSDL::RenderDisassembly(const SDL_FRect& rect) {
+    if (!state) return;
 
-    RenderSection(disassemblySection);
+    RenderSection(rect);
 
-    float x = disassemblySection.rect.x + 5.0f;
-    float y = disassemblySection.rect.y + 5.0f;
+    float x = rect.x + 5.0f;
+    float y = rect.y + 5.0f;
 
     // Section header
-    SDL_FRect headerRect = RenderSectionHeader("Disassembly", x, y, disassemblySection.rect.w - 10.0f);
+    SDL_FRect headerRect = RenderSectionHeader("Disassembly", x, y, rect.w - 10.0f);
     y += headerRect.h + 5.0f;
 
-    uint16_t pc = chip8Ptr->program_counter;
-    uint16_t addr = (pc >= 20) ? pc - 20 : 0x200;
+    uint16_t pc = state->program_counter;
+    uint16_t addr = GetDisassemblyStart();
 
     for (int i = 0; i < disassemblyView.instructionsToShow && addr < 4096 - 1; i++) {
-        uint16_t opcode = (chip8Ptr->memory[addr] << 8) | chip8Ptr->memory[addr + 1];
-        std::string instruction = DisassembleInstruction(opcode, addr);
+        uint16_t opcode = (state->memory[addr] << 8) | state->memory[addr + 1];
+        const char* instruction = disassemblyCache.Get(state->memory, addr);
 
-        SDL_Color instrColor = (addr == pc) ? pcColor : textColor;
-        std::string prefix = (addr == pc) ? ">> " : "   ";
+        bool breakpoint = HasBreakpoint(addr);
+        SDL_Color instrColor = (addr == pc) ? pcColor : (breakpoint ? breakpointColor : textColor);
+        const char* prefix = (addr == pc) ? (breakpoint ? "*> " : ">> ") : (breakpoint ? "*  " : "   ");
 
-        RenderTextF(x, y, instrColor, "%s%04X: %04X  %s",
-                   prefix.c_str(), addr, opcode, instruction.c_str());
+        RenderTextF(x, y, instrColor, "%s%04X: %04X  %s", prefix, addr, opcode, instruction);
 
         y += (float)lineHeight;
         addr += 2;
 
         // Don't overflow the section
-        if (y > disassemblySection.rect.y + disassemblySection.rect.h - (float)lineHeight) {
+        if (y > rect.y + rect.h - (float)lineHeight) {
             break;
         }
     }
 }
 
-void DebugSDL::RenderKeypad() {
-    if (!chip8Ptr) return;
+void DebugSDL::RenderKeypad(const SDL_FRect& rect) {
+    if (!state) return;
 
-    RenderSection(keypadSection);
+    RenderSection(rect);
 
-    float x = keypadSection.rect.x + 5.0f;
-    float y = keypadSection.rect.y + 5.0f;
+    float x = rect.x + 5.0f;
+    float y = rect.y + 5.0f;
 
     // Section header
-    SDL_FRect headerRect = RenderSectionHeader("Keypad", x, y, keypadSection.rect.w - 10.0f);
+    SDL_FRect headerRect = RenderSectionHeader("Keypad", x, y, rect.w - 10.0f);
     y += headerRect.h + 5.0f;
 
     RenderText("CHIP-8 Keypad Layout:", x, y, headerColor);
@@ -553,7 +919,7 @@ void DebugSDL::RenderKeypad() {
             SDL_FRect keyRect = {keyX, keyY, keySize, keySize};
 
             int keyIdx = keyIndices[row][col];
-            bool pressed = chip8Ptr->keypad[keyIdx] != 0;
+            bool pressed = state->keypad[keyIdx] != 0;
 
             // Key background
             if (pressed) {
@@ -574,83 +940,229 @@ void DebugSDL::RenderKeypad() {
     }
 }
 
-void DebugSDL::RenderGraphics() {
-    if (!chip8Ptr) return;
+void DebugSDL::RenderGraphics(const SDL_FRect& rect) {
+    if (!state) return;
 
-    RenderSection(graphicsSection);
+    RenderSection(rect);
 
-    float x = graphicsSection.rect.x + 5.0f;
-    float y = graphicsSection.rect.y + 5.0f;
+    float x = rect.x + 5.0f;
+    float y = rect.y + 5.0f;
 
     // Section header
-    SDL_FRect headerRect = RenderSectionHeader("Graphics Display", x, y, graphicsSection.rect.w - 10.0f);
+    SDL_FRect headerRect = RenderSectionHeader("Graphics Display", x, y, rect.w - 10.0f);
     y += headerRect.h + 5.0f;
 
-    // Calculate display area
-    float availableWidth = graphicsSection.rect.w - 10.0f;
-    float availableHeight = graphicsSection.rect.h - headerRect.h - 15.0f;
+    // Calculate display area, leaving a line for the provenance readout
+    float availableWidth = rect.w - 10.0f;
+    float availableHeight = rect.h - headerRect.h - 15.0f;
+    if (state->has_pixel_origins) {
+        availableHeight -= (float)lineHeight;
+    }
 
-    float scaleX = availableWidth / VIDEO_WIDTH;
-    float scaleY = availableHeight / VIDEO_HEIGHT;
+    float scaleX = availableWidth / (float)displayWidth;
+    float scaleY = availableHeight / (float)displayHeight;
     float scale = std::min(scaleX, scaleY);
 
-    float displayWidth = VIDEO_WIDTH * scale;
-    float displayHeight = VIDEO_HEIGHT * scale;
+    float displayWidthPx = (float)displayWidth * scale;
+    float displayHeightPx = (float)displayHeight * scale;
 
     // Center the display
-    float displayX = x + (availableWidth - displayWidth) / 2.0f;
-    float displayY = y + (availableHeight - displayHeight) / 2.0f;
-
-    // Draw CHIP-8 display
-    for (int py = 0; py < VIDEO_HEIGHT; py++) {
-        for (int px = 0; px < VIDEO_WIDTH; px++) {
-            SDL_FRect pixelRect = {
-                displayX + (float)px * scale,
-                displayY + (float)py * scale,
-                scale,
-                scale
-            };
-
-            uint32_t pixel = chip8Ptr->graphics[py * VIDEO_WIDTH + px];
-
-            if (pixel != 0) {
-                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);  // White for on pixels
-            } else {
-                SDL_SetRenderDrawColor(renderer, 40, 40, 50, 255);    // Dark for off pixels
-            }
-
-            SDL_RenderFillRect(renderer, &pixelRect);
-        }
+    float displayX = x + (availableWidth - displayWidthPx) / 2.0f;
+    float displayY = y + (availableHeight - displayHeightPx) / 2.0f;
+
+    // This only runs when the framebuffer hash changed, so the texture upload
+    // happens at most once per changed frame
+    if (UpdateDisplayTexture(state->graphics, displayWidth, displayHeight)) {
+        SDL_FRect displayRect = {displayX, displayY, displayWidthPx, displayHeightPx};
+        SDL_RenderTexture(renderer, displayTexture, nullptr, &displayRect);
     }
 
     // Draw border around display
-    SDL_FRect displayBorder = {displayX - 1.0f, displayY - 1.0f, displayWidth + 2.0f, displayHeight + 2.0f};
+    SDL_FRect displayBorder = {displayX - 1.0f, displayY - 1.0f, displayWidthPx + 2.0f, displayHeightPx + 2.0f};
     SDL_SetRenderDrawColor(renderer, borderColor.r, borderColor.g, borderColor.b, 255);
     SDL_RenderRect(renderer, &displayBorder);
+
+    displayArea = {displayX - rect.x, displayY - rect.y, displayWidthPx, displayHeightPx};
+
+    if (!state->has_pixel_origins) {
+        return;
+    }
+
+    // Which DXYN last drew the pixel under the mouse
+    float infoY = displayY + displayHeightPx + 5.0f;
+    int hovered = GetHoveredPixel();
+    if (hovered < 0) {
+        RenderText("Hover a pixel to see which instruction drew it", x, infoY, textColor);
+        return;
+    }
+
+    int px = hovered % displayWidth;
+    int py = hovered / displayWidth;
+    SDL_FRect pixelRect = {displayX + (float)px * scale, displayY + (float)py * scale, scale, scale};
+    SDL_SetRenderDrawColor(renderer, pcColor.r, pcColor.g, pcColor.b, 255);
+    SDL_RenderRect(renderer, &pixelRect);
+
+    const PixelOrigin& origin = state->pixel_origins[hovered];
+    if (origin.pc == 0) {
+        RenderTextF(x, infoY, textColor, "(%d,%d) never drawn", px, py);
+    } else {
+        RenderTextF(x, infoY, highlightColor, "(%d,%d) PC 0x%03X  I 0x%03X  frame %u (%u ago)",
+                    px, py, origin.pc, origin.index, origin.frame,
+                    (unsigned)(state->frame_count - origin.frame));
+    }
 }
 
-void DebugSDL::RenderText(const std::string& text, float x, float y, SDL_Color color) {
-    if (!font || text.empty() || !renderer) {
-        return; // Don't render rectangles as fallback
+int DebugSDL::GetHoveredPixel() const {
+    if (!graphicsSection.visible || showHeatMap || displayArea.w <= 0.0f || displayArea.h <= 0.0f) {
+        return -1;
     }
 
-    SDL_Surface* textSurface = TTF_RenderText_Blended(font, text.c_str(), text.length(), color);
-    if (!textSurface) {
+    float localX = mouseX - graphicsSection.rect.x - displayArea.x;
+    float localY = mouseY - graphicsSection.rect.y - displayArea.y;
+    if (localX < 0.0f || localY < 0.0f || localX >= displayArea.w || localY >= displayArea.h) {
+        return -1;
+    }
+
+    int px = (int)(localX * (float)displayWidth / displayArea.w);
+    int py = (int)(localY * (float)displayHeight / displayArea.h);
+    return py * displayWidth + px;
+}
+
+bool DebugSDL::UpdateDisplayTexture(const uint32_t* pixels, int width, int height) {
+    // (Re)create the texture when the display mode changes size, e.g. 128x64 hi-res
+    if (displayTexture) {
+        float w, h;
+        SDL_GetTextureSize(displayTexture, &w, &h);
+        if ((int)w != width || (int)h != height) {
+            SDL_DestroyTexture(displayTexture);
+            displayTexture = nullptr;
+        }
+    }
+
+    if (!displayTexture) {
+        displayTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+        if (!displayTexture) {
+            std::cerr << "Failed to create debug display texture: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        SDL_SetTextureScaleMode(displayTexture, SDL_SCALEMODE_NEAREST);
+    }
+
+    void* texturePixels;
+    int texturePitch;
+    if (!SDL_LockTexture(displayTexture, nullptr, &texturePixels, &texturePitch)) {
+        return false;
+    }
+
+    for (int py = 0; py < height; py++) {
+        uint32_t* row = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(texturePixels) + py * texturePitch);
+        const uint32_t* source = pixels + py * width;
+        for (int px = 0; px < width; px++) {
+            // White for on pixels, dark for off pixels (RGBA)
+            row[px] = source[px] ? 0xFFFFFFFF : 0x282832FF;
+        }
+    }
+
+    SDL_UnlockTexture(displayTexture);
+    return true;
+}
+
+void DebugSDL::UpdateHeat() {
+    if (!state->has_access_counts) {
         return;
     }
 
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    SDL_DestroySurface(textSurface);
+    const MemoryAccessCounts& counts = state->access_counts;
+    for (int addr = 0; addr < 4096; ++addr) {
+        // Counters only grow; a smaller value means the profile was restarted
+        uint32_t reads = counts.reads[addr] >= lastReads[addr] ? counts.reads[addr] - lastReads[addr] : counts.reads[addr];
+        uint32_t writes = counts.writes[addr] >= lastWrites[addr] ? counts.writes[addr] - lastWrites[addr] : counts.writes[addr];
+        readHeat[addr] = readHeat[addr] * HEAT_DECAY + (float)reads;
+        writeHeat[addr] = writeHeat[addr] * HEAT_DECAY + (float)writes;
+        lastReads[addr] = counts.reads[addr];
+        lastWrites[addr] = counts.writes[addr];
+    }
+}
 
-    if (!textTexture) {
+bool DebugSDL::UpdateHeatTexture() {
+    if (!heatTexture) {
+        heatTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, 64, 64);
+        if (!heatTexture) {
+            std::cerr << "Failed to create heat map texture: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        SDL_SetTextureScaleMode(heatTexture, SDL_SCALEMODE_NEAREST);
+    }
+
+    // Log scale against the hottest address so both busy loops and rarely
+    // touched tables stay visible
+    float maxHeat = 1.0f;
+    for (int addr = 0; addr < 4096; ++addr) {
+        maxHeat = std::max(maxHeat, std::max(readHeat[addr], writeHeat[addr]));
+    }
+    float scale = 255.0f / std::log1p(maxHeat);
+
+    void* texturePixels;
+    int texturePitch;
+    if (!SDL_LockTexture(heatTexture, nullptr, &texturePixels, &texturePitch)) {
+        return false;
+    }
+
+    for (int row = 0; row < 64; ++row) {
+        uint32_t* texels = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(texturePixels) + row * texturePitch);
+        for (int col = 0; col < 64; ++col) {
+            int addr = row * 64 + col;
+            // Writes in red, reads in green (RGBA)
+            uint32_t red = (uint32_t)(std::log1p(writeHeat[addr]) * scale);
+            uint32_t green = (uint32_t)(std::log1p(readHeat[addr]) * scale);
+            texels[col] = (red << 24) | (green << 16) | (0x30 << 8) | 0xFF;
+        }
+    }
+
+    SDL_UnlockTexture(heatTexture);
+    return true;
+}
+
+void DebugSDL::RenderHeatMap(const SDL_FRect& rect) {
+    if (!state) return;
+
+    RenderSection(rect);
+
+    float x = rect.x + 5.0f;
+    float y = rect.y + 5.0f;
+
+    SDL_FRect headerRect = RenderSectionHeader("Memory Heat Map (reads green, writes red)", x, y, rect.w - 10.0f);
+    y += headerRect.h + 5.0f;
+
+    if (!state->has_access_counts) {
+        RenderText("Access counting is off (run with --heatmap)", x, y, textColor);
         return;
     }
 
-    float w, h;
-    SDL_GetTextureSize(textTexture, &w, &h);
-    SDL_FRect destRect = {x, y, w, h};
-    SDL_RenderTexture(renderer, textTexture, nullptr, &destRect);
-    SDL_DestroyTexture(textTexture);
+    // One texel per address, 64 addresses per row
+    float availableWidth = rect.w - 10.0f;
+    float availableHeight = rect.h - headerRect.h - 15.0f - (float)lineHeight;
+    float size = std::min(availableWidth, availableHeight);
+    float mapX = x + (availableWidth - size) / 2.0f;
+
+    if (UpdateHeatTexture()) {
+        SDL_FRect mapRect = {mapX, y, size, size};
+        SDL_RenderTexture(renderer, heatTexture, nullptr, &mapRect);
+    }
+
+    SDL_FRect border = {mapX - 1.0f, y - 1.0f, size + 2.0f, size + 2.0f};
+    SDL_SetRenderDrawColor(renderer, borderColor.r, borderColor.g, borderColor.b, 255);
+    SDL_RenderRect(renderer, &border);
+
+    RenderText("Row = address / 64, column = address % 64", x, y + size + 5.0f, textColor);
+}
+
+void DebugSDL::RenderText(const char* text, float x, float y, SDL_Color color) {
+    if (!text || !*text) {
+        return;
+    }
+
+    glyphAtlas.AddText(text, x, y, color);
 }
 
 SDL_Texture* DebugSDL::CreateTextTexture(const std::string& text, SDL_Color color, TTF_Font* useFont) {
@@ -683,7 +1195,7 @@ void DebugSDL::RenderTextF(float x, float y, SDL_Color color, const char* format
     vsnprintf(buffer, sizeof(buffer), format, args);
     va_end(args);
 
-    RenderText(std::string(buffer), x, y, color);
+    glyphAtlas.AddText(buffer, x, y, color);
 }
 
 void DebugSDL::RenderTextTexture(SDL_Texture* texture, float x, float y) {
@@ -721,7 +1233,7 @@ SDL_FRect DebugSDL::GetTextSize(const std::string& text, TTF_Font* useFont) {
     return {0, 0, (float)w, (float)h};
 }
 
-SDL_FRect DebugSDL::RenderSectionHeader(const std::string& title, float x, float y, float width, bool collapsed) {
+SDL_FRect DebugSDL::RenderSectionHeader(const char* title, float x, float y, float width, bool collapsed) {
     SDL_FRect headerRect = {x, y, width, (float)lineHeight + 4.0f};
 
     // Header background
@@ -738,117 +1250,6 @@ SDL_FRect DebugSDL::RenderSectionHeader(const std::string& title, float x, float
     return headerRect;
 }
 
-std::string DebugSDL::FormatHex(uint16_t value, int width) {
-    std::stringstream ss;
-    ss << "0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(width) << value;
-    return ss.str();
-}
-
-std::string DebugSDL::FormatByte(uint8_t value) {
-    std::stringstream ss;
-    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << (int)value;
-    return ss.str();
-}
-
-std::string DebugSDL::DisassembleInstruction(uint16_t opcode, uint16_t address) {
-    std::stringstream ss;
-
-    switch (opcode & 0xF000) {
-        case 0x0000:
-            switch (opcode & 0x00FF) {
-                case 0x00E0: ss << "CLS"; break;
-                case 0x00EE: ss << "RET"; break;
-                default: ss << "SYS " << FormatHex(opcode & 0x0FFF, 3); break;
-            }
-            break;
-        case 0x1000: ss << "JP " << FormatHex(opcode & 0x0FFF, 3); break;
-        case 0x2000: ss << "CALL " << FormatHex(opcode & 0x0FFF, 3); break;
-        case 0x3000: ss << "SE V" << std::hex << ((opcode & 0x0F00) >> 8) << ", " << FormatByte(opcode & 0x00FF); break;
-        case 0x4000: ss << "SNE V" << std::hex << ((opcode & 0x0F00) >> 8) << ", " << FormatByte(opcode & 0x00FF); break;
-        case 0x5000: ss << "SE V" << std::hex << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4); break;
-        case 0x6000: ss << "LD V" << std::hex << ((opcode & 0x0F00) >> 8) << ", " << FormatByte(opcode & 0x00FF); break;
-        case 0x7000: ss << "ADD V" << std::hex << ((opcode & 0x0F00) >> 8) << ", " << FormatByte(opcode & 0x00FF); break;
-        case 0x8000:
-            switch (opcode & 0x000F) {
-                case 0x0000: ss << "LD V" << std::hex << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4); break;
-                case 0x0001: ss << "OR V" << std::hex << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4); break;
-                case 0x0002: ss << "AND V" << std::hex << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4); break;
-                case 0x0003: ss << "XOR V" << std::hex << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4); break;
-                case 0x0004: ss << "ADD V" << std::hex << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4); break;
-                case 0x0005: ss << "SUB V" << std::hex << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4); break;
-                case 0x0006: ss << "SHR V" << std::hex << ((opcode & 0x0F00) >> 8); break;
-                case 0x0007: ss << "SUBN V" << std::hex << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4); break;
-                case 0x000E: ss << "SHL V" << std::hex << ((opcode & 0x0F00) >> 8); break;
-                default: ss << "UNKNOWN 8xxx"; break;
-            }
-            break;
-        case 0x9000: ss << "SNE V" << std::hex << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4); break;
-        case 0xA000: ss << "LD I, " << FormatHex(opcode & 0x0FFF, 3); break;
-        case 0xB000: ss << "JP V0, " << FormatHex(opcode & 0x0FFF, 3); break;
-        case 0xC000: ss << "RND V" << std::hex << ((opcode & 0x0F00) >> 8) << ", " << FormatByte(opcode & 0x00FF); break;
-        case 0xD000: ss << "DRW V" << std::hex << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4) << ", " << (opcode & 0x000F); break;
-        case 0xE000:
-            switch (opcode & 0x00FF) {
-                case 0x009E: ss << "SKP V" << std::hex << ((opcode & 0x0F00) >> 8); break;
-                case 0x00A1: ss << "SKNP V" << std::hex << ((opcode & 0x0F00) >> 8); break;
-                default: ss << "UNKNOWN Exxx"; break;
-            }
-            break;
-        case 0xF000:
-            switch (opcode & 0x00FF) {
-                case 0x0007: ss << "LD V" << std::hex << ((opcode & 0x0F00) >> 8) << ", DT"; break;
-                case 0x000A: ss << "LD V" << std::hex << ((opcode & 0x0F00) >> 8) << ", K"; break;
-                case 0x0015: ss << "LD DT, V" << std::hex << ((opcode & 0x0F00) >> 8); break;
-                case 0x0018: ss << "LD ST, V" << std::hex << ((opcode & 0x0F00) >> 8); break;
-                case 0x001E: ss << "ADD I, V" << std::hex << ((opcode & 0x0F00) >> 8); break;
-                case 0x0029: ss << "LD F, V" << std::hex << ((opcode & 0x0F00) >> 8); break;
-                case 0x0033: ss << "LD B, V" << std::hex << ((opcode & 0x0F00) >> 8); break;
-                case 0x0055: ss << "LD [I], V" << std::hex << ((opcode & 0x0F00) >> 8); break;
-                case 0x0065: ss << "LD V" << std::hex << ((opcode & 0x0F00) >> 8) << ", [I]"; break;
-                default: ss << "UNKNOWN Fxxx"; break;
-            }
-            break;
-        default:
-            ss << "UNKNOWN";
-            break;
-    }
-
-    return ss.str();
-}
-
-std::vector<std::string> DebugSDL::GetMemoryDump(uint16_t start, uint16_t end, int bytesPerRow) {
-    if (!chip8Ptr) return {};
-
-    std::vector<std::string> lines;
-
-    for (uint16_t addr = start; addr < end; addr += bytesPerRow) {
-        std::stringstream line;
-        line << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << addr << ": ";
-
-        // Hex bytes
-        for (int i = 0; i < bytesPerRow && addr + i < end; i++) {
-            line << std::setfill('0') << std::setw(2) << (int)chip8Ptr->memory[addr + i] << " ";
-        }
-
-        // Padding for incomplete rows
-        for (int i = (end - addr); i < bytesPerRow; i++) {
-            line << "   ";
-        }
-
-        line << " ";
-
-        // ASCII representation
-        for (int i = 0; i < bytesPerRow && addr + i < end; i++) {
-            uint8_t byte = chip8Ptr->memory[addr + i];
-            line << (char)((byte >= 32 && byte <= 126) ? byte : '.');
-        }
-
-        lines.push_back(line.str());
-    }
-
-    return lines;
-}
-
 void DebugSDL::HandleMouseClick(float x, float y) {
     // Check if click is on section headers to toggle collapse/expand
     if (IsPointInRect(x, y, {registersSection.rect.x, registersSection.rect.y, registersSection.rect.w, (float)lineHeight + 4.0f})) {
@@ -876,10 +1277,19 @@ void DebugSDL::HandleMouseClick(float x, float y) {
         // For example, clicking on an address could center the view on that address
     }
 
-    // Handle disassembly clicks - could implement breakpoints
-    if (IsPointInRect(x, y, disassemblySection.rect) && !disassemblySection.collapsed) {
-        // Could implement breakpoint setting here
-        // Calculate which instruction was clicked and set/clear breakpoint
+    // Clicking an instruction in the disassembly toggles a breakpoint on it
+    if (IsPointInRect(x, y, disassemblySection.rect) && !disassemblySection.collapsed && state) {
+        // Rows start below the header, as laid out by RenderDisassembly
+        float firstRowY = disassemblySection.rect.y + 5.0f + (float)lineHeight + 4.0f + 5.0f;
+        if (y >= firstRowY) {
+            int row = (int)((y - firstRowY) / (float)lineHeight);
+            if (row < disassemblyView.instructionsToShow) {
+                int address = GetDisassemblyStart() + row * 2;
+                if (address < 4096 - 1) {
+                    SendCommand(DebugCommandType::ToggleBreakpoint, (uint16_t)address);
+                }
+            }
+        }
     }
 }
 
@@ -940,6 +1350,10 @@ void DebugSDL::HandleKeyPress(SDL_Keycode key) {
                 memoryView.followPC = false;
             }
             break;
+        case SDLK_H:
+            // Switch the graphics panel between the display and the heat map
+            showHeatMap = !showHeatMap;
+            break;
         case SDLK_HOME:
             // Go to beginning of program memory
             memoryView.startAddress = 0x200;
@@ -951,6 +1365,28 @@ void DebugSDL::HandleKeyPress(SDL_Keycode key) {
             memoryView.followPC = true;
             disassemblyView.followPC = true;
             break;
+        case SDLK_SPACE:
+            // Pause or continue emulation
+            if (state && state->paused) {
+                SendCommand(DebugCommandType::Continue);
+            } else {
+                SendCommand(DebugCommandType::Pause);
+            }
+            break;
+        case SDLK_N:
+            // Execute one instruction while paused
+            SendCommand(DebugCommandType::Step);
+            break;
+        case SDLK_P:
+            // Undo the last executed instruction
+            SendCommand(DebugCommandType::StepBack);
+            break;
+        case SDLK_B:
+            // Toggle a breakpoint at the current PC
+            if (state) {
+                SendCommand(DebugCommandType::ToggleBreakpoint, state->program_counter);
+            }
+            break;
         case SDLK_ESCAPE:
         case SDLK_TAB:
             // Toggle debug window visibility
@@ -6,13 +6,27 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <chrono>
 #include "chip8.h"
+#include "StateSnapshot.h"
+#include "DebugCommands.h"
+#include "GlyphAtlasSDL.h"
+#include "DisassemblyCache.h"
+#include "MemoryDiff.h"
 
 struct DebugSection {
-    SDL_FRect rect;
+    SDL_FRect rect{};
     std::string title;
-    bool visible;
-    bool collapsed;
+    bool visible = true;
+    bool collapsed = false;
+
+    // Retained rendering: the panel is redrawn into its cache texture only
+    // when the hash of the state it shows changes
+    SDL_Texture* cache = nullptr;
+    int cacheWidth = 0;
+    int cacheHeight = 0;
+    uint64_t contentHash = 0;
+    bool cacheValid = false;
 };
 
 struct MemoryView {
@@ -27,7 +41,6 @@ struct DisassemblyView {
     uint16_t currentAddress;
     int instructionsToShow;
     bool followPC;
-    std::vector<std::string> disassembledInstructions;
 };
 
 class DebugSDL {
@@ -38,12 +51,30 @@ public:
     bool Initialize(const char* title, int width = 1200, int height = 800);
     void Shutdown();
 
+    // Run the debugger at its own refresh rate, reading state only from the
+    // snapshots the emulator publishes. SDL windows belong to the main thread
+    // (and on Windows, to the thread whose queue receives their messages), so
+    // the main loop calls Tick() and a frame is drawn whenever one is due;
+    // the loop then runs the cycles that came due while the frame was drawn.
+    // Run control (pause, step, breakpoints) is sent back through commands
+    bool Start(const char* title, int width, int height, SnapshotBuffer& snapshots,
+               DebugCommandQueue* commands = nullptr, int refreshHz = 30);
+    void Stop();
+    void Tick();
+
+    // Events from the main loop's pump, handled on the next frame
+    void PostEvent(const SDL_Event& e);
+    bool IsCloseRequested() const { return closeRequested; }
+
     bool IsEnabled() const { return enabled; }
     void SetEnabled(bool enable) { enabled = enable; }
 
-    void Update(chip8* emulator);
+    void Update(const Chip8Snapshot* snapshot);
     void Render();
-    bool HandleEvents();
+    // Returns true when the debug window asked to be closed
+    bool HandleEvent(const SDL_Event& e);
+
+    SDL_WindowID GetWindowID() const { return windowID; }
 
     // Configuration
     void ToggleSection(const std::string& sectionName);
@@ -56,11 +87,42 @@ private:
     TTF_Font* font;           // Add font support
     TTF_Font* smallFont;      // For smaller text
     std::string loadedFontPath;
+    GlyphAtlasSDL glyphAtlas; // All debugger text, drawn in one batch per frame
+
+    // Streaming copy of the emulated display for the graphics panel, sized
+    // like the latest snapshot's display
+    SDL_Texture* displayTexture;
+    int displayWidth, displayHeight;
+    SDL_FRect displayArea;      // Where the display was drawn, relative to its panel
+    float mouseX, mouseY;       // Last mouse position, for pixel provenance
+
+    // Memory access heat map (64x64 texels, one per address), shown in place
+    // of the display. Heat is the decayed count of accesses per snapshot.
+    bool showHeatMap;
+    SDL_Texture* heatTexture;
+    float readHeat[4096];
+    float writeHeat[4096];
+    uint32_t lastReads[4096];
+    uint32_t lastWrites[4096];
 
     // State
     bool enabled;
     bool initialized;
-    chip8* chip8Ptr;
+    bool needsRedraw;   // Window or layout changed, recomposite even if no panel did
+    const Chip8Snapshot* state;
+    uint64_t renderedSequence;
+
+    // Main loop hand-off
+    bool closeRequested;
+    SDL_WindowID windowID;
+    SnapshotBuffer* snapshotSource;
+    DebugCommandQueue* commandQueue;
+    std::chrono::steady_clock::time_point nextFrameTime;
+    std::chrono::microseconds framePeriod;
+
+    // Events handed over by the main loop's pump
+    std::vector<SDL_Event> pendingEvents;
+    std::vector<SDL_Event> processingEvents;
 
     // UI Layout
     int windowWidth, windowHeight;
@@ -80,6 +142,8 @@ private:
     // Views
     MemoryView memoryView;
     DisassemblyView disassemblyView;
+    DisassemblyCache disassemblyCache;
+    MemoryDiff memoryDiff;      // Which bytes changed, and how long ago
 
     // Colors
     SDL_Color bgColor;
@@ -89,8 +153,10 @@ private:
     SDL_Color borderColor;
     SDL_Color pcColor;
     SDL_Color activeColor;
+    SDL_Color breakpointColor;
 
     // Helper methods
+    void RunFrame();
     bool InitializeSDL();
     bool InitializeFonts();   // Add font initialization
     void SetupLayout();
@@ -99,31 +165,49 @@ private:
     void EnforceMinimumSizes();
 
     // Rendering methods
+    // Panels draw into a rect local to their cache texture
+    typedef void (DebugSDL::*PanelRenderer)(const SDL_FRect& rect);
+    void RenderPanel(DebugSection& section, uint64_t stateHash, PanelRenderer draw);
+    void ReleasePanelCache(DebugSection& section);
+    void SetSectionLayout(DebugSection& section, const SDL_FRect& rect, const char* title);
+
     void RenderBackground();
-    void RenderSection(const DebugSection& section);
-    void RenderRegisters();
-    void RenderMemory();
-    void RenderStack();
-    void RenderDisassembly();
-    void RenderKeypad();
-    void RenderGraphics();
-
-    // Text rendering helpers (now with proper TTF support)
-    void RenderText(const std::string& text, float x, float y, SDL_Color color = {255, 255, 255, 255});
+    void RenderSection(const SDL_FRect& rect);
+    void RenderRegisters(const SDL_FRect& rect);
+    void RenderMemory(const SDL_FRect& rect);
+    void RenderStack(const SDL_FRect& rect);
+    void RenderDisassembly(const SDL_FRect& rect);
+    void RenderKeypad(const SDL_FRect& rect);
+    void RenderGraphics(const SDL_FRect& rect);
+    bool UpdateDisplayTexture(const uint32_t* pixels, int width, int height);
+    int GetHoveredPixel() const;
+    void RenderHeatMap(const SDL_FRect& rect);
+    void UpdateHeat();
+    bool UpdateHeatTexture();
+
+    // Cheap per-panel state hashes
+    uint64_t HashRegisters() const;
+    uint64_t HashMemoryView() const;
+    uint64_t HashStack() const;
+    uint64_t HashDisassembly() const;
+    uint64_t HashKeypad() const;
+    uint64_t HashGraphics() const;
+
+    uint16_t GetDisassemblyStart() const;
+    SDL_Color GetChangeColor(uint8_t age, SDL_Color base) const;
+    bool HasBreakpoint(uint16_t address) const;
+    void SendCommand(DebugCommandType type, uint16_t address = 0);
+
+    // Text rendering helpers (queued into the glyph atlas batch)
+    void RenderText(const char* text, float x, float y, SDL_Color color = {255, 255, 255, 255});
     void RenderTextF(float x, float y, SDL_Color color, const char* format, ...);
-    SDL_FRect RenderSectionHeader(const std::string& title, float x, float y, float width, bool collapsed = false);
+    SDL_FRect RenderSectionHeader(const char* title, float x, float y, float width, bool collapsed = false);
 
     // Additional text helpers
     SDL_Texture* CreateTextTexture(const std::string& text, SDL_Color color, TTF_Font* useFont = nullptr);
     void RenderTextTexture(SDL_Texture* texture, float x, float y);
     SDL_FRect GetTextSize(const std::string& text, TTF_Font* useFont = nullptr);
 
-    // Utility methods
-    std::string FormatHex(uint16_t value, int width = 4);
-    std::string FormatByte(uint8_t value);
-    std::string DisassembleInstruction(uint16_t opcode, uint16_t address);
-    std::vector<std::string> GetMemoryDump(uint16_t start, uint16_t end, int bytesPerRow);
-
     // Input handling
     void HandleMouseClick(float x, float y);
     void HandleKeyPress(SDL_Keycode key);
@@ -0,0 +1,109 @@
+#include "DisassemblyCache.h"
+#include <cstdio>
+#include <cstring>
+
+// Bytes compared at a time when looking for writes
+const int SYNC_BLOCK = 64;
+
+DisassemblyCache::DisassemblyCache() : text{}, valid{}, shadow{} {
+}
+
+void DisassemblyCache::Sync(const uint8_t* memory) {
+    for (int block = 0; block < ADDRESS_SPACE; block += SYNC_BLOCK) {
+        if (std::memcmp(shadow + block, memory + block, SYNC_BLOCK) == 0) {
+            continue;
+        }
+
+        for (int addr = block; addr < block + SYNC_BLOCK; ++addr) {
+            if (shadow[addr] != memory[addr]) {
+                // A byte is the low half of the instruction before it too
+                valid[addr] = false;
+                if (addr > 0) valid[addr - 1] = false;
+                shadow[addr] = memory[addr];
+            }
+        }
+    }
+}
+
+void DisassemblyCache::InvalidateAll() {
+    std::memset(valid, 0, sizeof(valid));
+}
+
+const char* DisassemblyCache::Get(const uint8_t* memory, uint16_t address) {
+    if (address >= ADDRESS_SPACE - 1) {
+        return "";
+    }
+
+    if (!valid[address]) {
+        uint16_t opcode = (memory[address] << 8) | memory[address + 1];
+        Disassemble(opcode, text[address], TEXT_SIZE);
+        valid[address] = true;
+    }
+
+    return text[address];
+}
+
+void DisassemblyCache::Disassemble(uint16_t opcode, char* out, size_t size) {
+    unsigned x = (opcode & 0x0F00) >> 8;
+    unsigned y = (opcode & 0x00F0) >> 4;
+    unsigned n = opcode & 0x000F;
+    unsigned kk = opcode & 0x00FF;
+    unsigned nnn = opcode & 0x0FFF;
+
+    switch (opcode & 0xF000) {
+        case 0x0000:
+            switch (opcode & 0x00FF) {
+                case 0x00E0: snprintf(out, size, "CLS"); break;
+                case 0x00EE: snprintf(out, size, "RET"); break;
+                default: snprintf(out, size, "SYS 0x%03X", nnn); break;
+            }
+            break;
+        case 0x1000: snprintf(out, size, "JP 0x%03X", nnn); break;
+        case 0x2000: snprintf(out, size, "CALL 0x%03X", nnn); break;
+        case 0x3000: snprintf(out, size, "SE V%x, %02X", x, kk); break;
+        case 0x4000: snprintf(out, size, "SNE V%x, %02X", x, kk); break;
+        case 0x5000: snprintf(out, size, "SE V%x, V%x", x, y); break;
+        case 0x6000: snprintf(out, size, "LD V%x, %02X", x, kk); break;
+        case 0x7000: snprintf(out, size, "ADD V%x, %02X", x, kk); break;
+        case 0x8000:
+            switch (opcode & 0x000F) {
+                case 0x0000: snprintf(out, size, "LD V%x, V%x", x, y); break;
+                case 0x0001: snprintf(out, size, "OR V%x, V%x", x, y); break;
+                case 0x0002: snprintf(out, size, "AND V%x, V%x", x, y); break;
+                case 0x0003: snprintf(out, size, "XOR V%x, V%x", x, y); break;
+                case 0x0004: snprintf(out, size, "ADD V%x, V%x", x, y); break;
+                case 0x0005: snprintf(out, size, "SUB V%x, V%x", x, y); break;
+                case 0x0006: snprintf(out, size, "SHR V%x", x); break;
+                case 0x0007: snprintf(out, size, "SUBN V%x, V%x", x, y); break;
+                case 0x000E: snprintf(out, size, "SHL V%x", x); break;
+                default: snprintf(out, size, "UNKNOWN 8xxx"); break;
+            }
+            break;
+        case 0x9000: snprintf(out, size, "SNE V%x, V%x", x, y); break;
+        case 0xA000: snprintf(out, size, "LD I, 0x%03X", nnn); break;
+        case 0xB000: snprintf(out, size, "JP V0, 0x%03X", nnn); break;
+        case 0xC000: snprintf(out, size, "RND V%x, %02X", x, kk); break;
+        case 0xD000: snprintf(out, size, "DRW V%x, V%x, %x", x, y, n); break;
+        case 0xE000:
+            switch (opcode & 0x00FF) {
+                case 0x009E: snprintf(out, size, "SKP V%x", x); break;
+                case 0x00A1: snprintf(out, size, "SKNP V%x", x); break;
+                default: snprintf(out, size, "UNKNOWN Exxx"); break;
+            }
+            break;
+        case 0xF000:
+            switch (opcode & 0x00FF) {
+                case 0x0007: snprintf(out, size, "LD V%x, DT", x); break;
+                case 0x000A: snprintf(out, size, "LD V%x, K", x); break;
+                case 0x0015: snprintf(out, size, "LD DT, V%x", x); break;
+                case 0x0018: snprintf(out, size, "LD ST, V%x", x); break;
+                case 0x001E: snprintf(out, size, "ADD I, V%x", x); break;
+                case 0x0029: snprintf(out, size, "LD F, V%x", x); break;
+                case 0x0033: snprintf(out, size, "LD B, V%x", x); break;
+                case 0x0055: snprintf(out, size, "LD [I], V%x", x); break;
+                case 0x0065: snprintf(out, size, "LD V%x, [I]", x); break;
+                default: snprintf(out, size, "UNKNOWN Fxxx"); break;
+            }
+            break;
+    }
+}
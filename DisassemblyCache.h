@@ -0,0 +1,33 @@
+#ifndef DISASSEMBLYCACHE_H
+#define DISASSEMBLYCACHE_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Disassembly text for every address, formatted once into fixed buffers and
+// kept until one of the two bytes it was decoded from changes.
+class DisassemblyCache {
+public:
+    static const int ADDRESS_SPACE = 4096;
+    static const int TEXT_SIZE = 24;
+
+    DisassemblyCache();
+
+    // Compare memory against the copy the cache was built from and drop the
+    // entries that cover changed bytes
+    void Sync(const uint8_t* memory);
+    void InvalidateAll();
+
+    // Mnemonic for the instruction at address, decoded on first use
+    const char* Get(const uint8_t* memory, uint16_t address);
+
+    // Format one opcode into out (no allocation)
+    static void Disassemble(uint16_t opcode, char* out, size_t size);
+
+private:
+    char text[ADDRESS_SPACE][TEXT_SIZE];
+    bool valid[ADDRESS_SPACE];
+    uint8_t shadow[ADDRESS_SPACE];
+};
+
+#endif // DISASSEMBLYCACHE_H
@@ -0,0 +1,66 @@
+#include "EventDispatcherSDL.h"
+#include <algorithm>
+
+void EventDispatcherSDL::Register(SDL_WindowID windowID, Handler handler) {
+    Unregister(windowID);
+    routes.push_back({windowID, std::move(handler)});
+}
+
+void EventDispatcherSDL::Unregister(SDL_WindowID windowID) {
+    routes.erase(std::remove_if(routes.begin(), routes.end(),
+                                [windowID](const Route& route) { return route.windowID == windowID; }),
+                 routes.end());
+}
+
+bool EventDispatcherSDL::Pump() {
+    bool quit = false;
+    SDL_Event e;
+
+    while (SDL_PollEvent(&e)) {
+        if (e.type == SDL_EVENT_QUIT) {
+            quit = true;
+            continue;
+        }
+
+        // Events that are not tied to a window are not routed
+        SDL_WindowID windowID = GetEventWindowID(e);
+        if (windowID == 0) {
+            continue;
+        }
+
+        for (const Route& route : routes) {
+            if (route.windowID == windowID) {
+                if (route.handler(e)) {
+                    quit = true;
+                }
+                break;
+            }
+        }
+    }
+
+    return quit;
+}
+
+SDL_WindowID EventDispatcherSDL::GetEventWindowID(const SDL_Event& e) {
+    switch (e.type) {
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+            return e.key.windowID;
+
+        case SDL_EVENT_MOUSE_MOTION:
+            return e.motion.windowID;
+
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+            return e.button.windowID;
+
+        case SDL_EVENT_MOUSE_WHEEL:
+            return e.wheel.windowID;
+
+        default:
+            if (e.type >= SDL_EVENT_WINDOW_FIRST && e.type <= SDL_EVENT_WINDOW_LAST) {
+                return e.window.windowID;
+            }
+            return 0;
+    }
+}
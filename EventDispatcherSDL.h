@@ -0,0 +1,32 @@
+#ifndef EVENTDISPATCHERSDL_H
+#define EVENTDISPATCHERSDL_H
+
+#include <SDL3/SDL.h>
+#include <functional>
+#include <vector>
+
+// Drains the SDL event queue once per loop iteration and hands each event to
+// the handler registered for the window it belongs to. Handlers return true
+// to request that the emulator quit.
+class EventDispatcherSDL {
+public:
+    using Handler = std::function<bool(const SDL_Event&)>;
+
+    void Register(SDL_WindowID windowID, Handler handler);
+    void Unregister(SDL_WindowID windowID);
+
+    // Returns true when the application should quit
+    bool Pump();
+
+private:
+    struct Route {
+        SDL_WindowID windowID;
+        Handler handler;
+    };
+
+    std::vector<Route> routes;
+
+    static SDL_WindowID GetEventWindowID(const SDL_Event& e);
+};
+
+#endif // EVENTDISPATCHERSDL_H
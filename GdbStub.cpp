@@ -0,0 +1,559 @@
+#include "GdbStub.h"
+#include "chip8.h"
+#include "Breakpoints.h"
+#include "DebugCommands.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#define CLOSE_SOCKET closesocket
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define CLOSE_SOCKET close
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// Registers exposed to the client: V0-VF, I, PC, SP, DT, ST
+const int REGISTER_COUNT = 21;
+
+// Unsent replies kept for a client whose socket buffer is full
+const size_t MAX_QUEUED_OUTPUT = 1 << 20;
+
+static bool SetNonBlocking(intptr_t socket) {
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket((SOCKET)socket, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl((int)socket, F_GETFL, 0);
+    return flags >= 0 && fcntl((int)socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+static std::string ToHex(const uint8_t* data, size_t size) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(size * 2);
+    for (size_t i = 0; i < size; ++i) {
+        out += digits[data[i] >> 4];
+        out += digits[data[i] & 0xF];
+    }
+    return out;
+}
+
+static int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool FromHex(const std::string& text, uint8_t* out, size_t size) {
+    if (text.size() < size * 2) return false;
+    for (size_t i = 0; i < size; ++i) {
+        int high = HexValue(text[i * 2]);
+        int low = HexValue(text[i * 2 + 1]);
+        if (high < 0 || low < 0) return false;
+        out[i] = (uint8_t)((high << 4) | low);
+    }
+    return true;
+}
+
+// Register n as little-endian bytes; returns its size
+static int ReadRegister(const chip8& emulator, int n, uint8_t* out) {
+    if (n < 16) {
+        out[0] = emulator.registers_V[n];
+        return 1;
+    }
+
+    uint16_t value;
+    switch (n) {
+        case 16: value = emulator.index_register; break;
+        case 17: value = emulator.program_counter; break;
+        case 18: value = emulator.stack_pointer; break;
+        case 19: out[0] = emulator.delay_timer; return 1;
+        case 20: out[0] = emulator.sound_timer; return 1;
+        default: return 0;
+    }
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    return 2;
+}
+
+static void WriteRegister(chip8& emulator, int n, const uint8_t* in) {
+    uint16_t value = (uint16_t)(in[0] | (n >= 16 && n <= 18 ? in[1] << 8 : 0));
+    if (n < 16) {
+        emulator.registers_V[n] = in[0];
+    }
+    switch (n) {
+        case 16: emulator.index_register = value & 0xFFF; break;
+        case 17: emulator.program_counter = value & 0xFFF; break;
+        case 18: emulator.stack_pointer = value > 16 ? 16 : value; break;
+        case 19: emulator.delay_timer = in[0]; break;
+        case 20: emulator.sound_timer = in[0]; break;
+    }
+}
+
+GdbStub::GdbStub() : listenSocket(INVALID), clientSocket(INVALID), running(false), killRequested(false) {
+}
+
+GdbStub::~GdbStub() {
+    Close();
+}
+
+bool GdbStub::Listen(const std::string& address) {
+    Close();
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::cerr << "GDB stub: WSAStartup failed" << std::endl;
+        return false;
+    }
+    if (!OpenListener(address)) {
+        WSACleanup();
+        return false;
+    }
+    return true;
+#else
+    return OpenListener(address);
+#endif
+}
+
+bool GdbStub::OpenListener(const std::string& address) {
+    Socket fd = INVALID;
+
+    if (address.compare(0, 5, "unix:") == 0) {
+#ifdef _WIN32
+        std::cerr << "GDB stub: Unix sockets are not supported on this platform" << std::endl;
+        return false;
+#else
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::string path = address.substr(5);
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "GDB stub: bad socket path " << path << std::endl;
+            return false;
+        }
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(path.c_str());
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || bind((int)fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            std::cerr << "GDB stub: cannot bind " << path << std::endl;
+            if (fd >= 0) CLOSE_SOCKET((int)fd);
+            return false;
+        }
+        unixPath = path;
+#endif
+    } else {
+        // Accept "port" or "host:port"; always bound to the loopback interface
+        size_t colon = address.rfind(':');
+        int port = std::atoi(address.substr(colon == std::string::npos ? 0 : colon + 1).c_str());
+        if (port <= 0 || port > 65535) {
+            std::cerr << "GDB stub: bad port in " << address << std::endl;
+            return false;
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        fd = (Socket)socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+        if (fd == INVALID || bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            std::cerr << "GDB stub: cannot bind 127.0.0.1:" << port << std::endl;
+            if (fd != INVALID) CLOSE_SOCKET(fd);
+            return false;
+        }
+    }
+
+    if (listen(fd, 1) != 0 || !SetNonBlocking(fd)) {
+        std::cerr << "GDB stub: cannot listen on " << address << std::endl;
+        CLOSE_SOCKET(fd);
+        return false;
+    }
+
+    listenSocket = fd;
+    std::cout << "GDB stub listening on " << address << std::endl;
+    return true;
+}
+
+void GdbStub::Close() {
+    // Last chance for queued replies such as the exit status
+    FlushOutput();
+    Disconnect();
+
+    if (listenSocket != INVALID) {
+        CLOSE_SOCKET(listenSocket);
+        listenSocket = INVALID;
+#ifdef _WIN32
+        WSACleanup();
+#else
+        if (!unixPath.empty()) unlink(unixPath.c_str());
+#endif
+        unixPath.clear();
+    }
+}
+
+void GdbStub::Disconnect() {
+    if (clientSocket != INVALID) {
+        CLOSE_SOCKET(clientSocket);
+        clientSocket = INVALID;
+    }
+    input.clear();
+    output.clear();
+    running = false;
+}
+
+void GdbStub::Accept(DebugCommandQueue& commands) {
+    Socket fd = (Socket)accept(listenSocket, nullptr, nullptr);
+    if (fd == INVALID || fd < 0) {
+        return;
+    }
+
+    SetNonBlocking(fd);
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
+    clientSocket = fd;
+    running = false;
+
+    // A debugger expects the target to be stopped once attached
+    commands.Push(DebugCommandType::Pause);
+    std::cout << "GDB client connected" << std::endl;
+}
+
+void GdbStub::SendRaw(const std::string& data) {
+    if (clientSocket == INVALID) {
+        return;
+    }
+
+    // A client that stopped reading would otherwise grow the queue forever
+    if (output.size() + data.size() > MAX_QUEUED_OUTPUT) {
+        std::cerr << "GDB client is not reading replies, disconnecting" << std::endl;
+        Disconnect();
+        return;
+    }
+
+    output += data;
+    FlushOutput();
+}
+
+void GdbStub::FlushOutput() {
+    size_t sent = 0;
+    while (sent < output.size() && clientSocket != INVALID) {
+        int result = (int)send(clientSocket, output.data() + sent, (int)(output.size() - sent), MSG_NOSIGNAL);
+        if (result <= 0) {
+#ifdef _WIN32
+            bool full = WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+            bool full = errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+            if (!full) {
+                Disconnect();
+                return;
+            }
+            // Socket buffer full: keep the rest for the next Poll()
+            break;
+        }
+        sent += (size_t)result;
+    }
+    output.erase(0, sent);
+}
+
+void GdbStub::SendPacket(const std::string& payload) {
+    uint8_t checksum = 0;
+    for (char c : payload) checksum += (uint8_t)c;
+
+    char trailer[4];
+    snprintf(trailer, sizeof(trailer), "#%02x", checksum);
+    SendRaw("$" + payload + trailer);
+}
+
+std::string GdbStub::StopReply(const chip8& emulator) const {
+    char reply[32];
+    switch (emulator.break_reason) {
+        case BreakReason::ReadWatch:
+            snprintf(reply, sizeof(reply), "T05rwatch:%x;", emulator.break_address);
+            break;
+        case BreakReason::WriteWatch:
+            snprintf(reply, sizeof(reply), "T05watch:%x;", emulator.break_address);
+            break;
+        case BreakReason::Breakpoint:
+            snprintf(reply, sizeof(reply), "T05swbreak:;");
+            break;
+        default:
+            snprintf(reply, sizeof(reply), "S05");
+            break;
+    }
+    return reply;
+}
+
+void GdbStub::NotifyStopped(const chip8& emulator) {
+    if (running && clientSocket != INVALID) {
+        running = false;
+        SendPacket(StopReply(emulator));
+    }
+}
+
+void GdbStub::NotifyExited(int status) {
+    if (clientSocket != INVALID) {
+        char reply[8];
+        snprintf(reply, sizeof(reply), "W%02x", status & 0xFF);
+        SendPacket(reply);
+        running = false;
+    }
+}
+
+void GdbStub::Poll(chip8& emulator, Breakpoints& breakpoints, DebugCommandQueue& commands) {
+    if (listenSocket == INVALID) {
+        return;
+    }
+
+    if (clientSocket == INVALID) {
+        Accept(commands);
+        if (clientSocket == INVALID) return;
+    }
+
+    FlushOutput();
+    if (clientSocket == INVALID) return;
+
+    char buffer[4096];
+    for (;;) {
+        int received = (int)recv(clientSocket, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            input.append(buffer, (size_t)received);
+            continue;
+        }
+        if (received == 0) {
+            std::cout << "GDB client disconnected" << std::endl;
+            Disconnect();
+            commands.Push(DebugCommandType::Continue);
+            return;
+        }
+        break;  // Would block: everything available has been read
+    }
+
+    size_t pos = 0;
+    while (pos < input.size() && clientSocket != INVALID) {
+        char c = input[pos];
+
+        if (c == '+' || c == '-') {
+            // Acknowledgements; packets are never resent
+            ++pos;
+        } else if (c == 0x03) {
+            // Interrupt from the client
+            ++pos;
+            commands.Push(DebugCommandType::Pause);
+            if (running) {
+                running = false;
+                SendPacket("S02");
+            }
+        } else if (c == '$') {
+            size_t hash = input.find('#', pos);
+            if (hash == std::string::npos || hash + 2 >= input.size()) {
+                break;  // Incomplete packet, wait for the rest
+            }
+
+            std::string packet = input.substr(pos + 1, hash - pos - 1);
+            uint8_t checksum = 0;
+            for (char p : packet) checksum += (uint8_t)p;
+            int expected = (HexValue(input[hash + 1]) << 4) | HexValue(input[hash + 2]);
+            pos = hash + 3;
+
+            if (expected != checksum) {
+                SendRaw("-");
+                continue;
+            }
+            SendRaw("+");
+
+            bool reply = true;
+            std::string response = HandlePacket(packet, emulator, breakpoints, commands, reply);
+            if (reply) {
+                SendPacket(response);
+            }
+        } else {
+            ++pos;
+        }
+    }
+
+    input.erase(0, pos);
+}
+
+std::string GdbStub::HandlePacket(const std::string& packet, chip8& emulator, Breakpoints& breakpoints,
+                                  DebugCommandQueue& commands, bool& reply) {
+    if (packet.empty()) {
+        return "";
+    }
+
+    const char* args = packet.c_str() + 1;
+
+    switch (packet[0]) {
+        case '?':
+            return StopReply(emulator);
+
+        case 'g': {
+            std::string out;
+            for (int n = 0; n < REGISTER_COUNT; ++n) {
+                uint8_t bytes[2];
+                int size = ReadRegister(emulator, n, bytes);
+                out += ToHex(bytes, (size_t)size);
+            }
+            return out;
+        }
+
+        case 'G': {
+            std::string data = packet.substr(1);
+            size_t offset = 0;
+            for (int n = 0; n < REGISTER_COUNT; ++n) {
+                uint8_t bytes[2];
+                int size = ReadRegister(emulator, n, bytes);
+                if (!FromHex(data.substr(offset), bytes, (size_t)size)) return "E01";
+                WriteRegister(emulator, n, bytes);
+                offset += (size_t)size * 2;
+            }
+            return "OK";
+        }
+
+        case 'p': {
+            int n = (int)std::strtol(args, nullptr, 16);
+            uint8_t bytes[2];
+            int size = ReadRegister(emulator, n, bytes);
+            return size ? ToHex(bytes, (size_t)size) : "E01";
+        }
+
+        case 'P': {
+            char* end;
+            int n = (int)std::strtol(args, &end, 16);
+            uint8_t bytes[2] = {0, 0};
+            int size = ReadRegister(emulator, n, bytes);
+            if (!size || *end != '=' || !FromHex(end + 1, bytes, (size_t)size)) return "E01";
+            WriteRegister(emulator, n, bytes);
+            return "OK";
+        }
+
+        case 'm':
+        case 'M': {
+            char* end;
+            unsigned long address = std::strtoul(args, &end, 16);
+            if (*end != ',') return "E01";
+            unsigned long length = std::strtoul(end + 1, &end, 16);
+            if (address >= PagedMemory::SIZE) return "E01";
+            length = std::min<unsigned long>(length, PagedMemory::SIZE - address);
+
+            uint8_t bytes[PagedMemory::SIZE];
+            if (packet[0] == 'm') {
+                emulator.memory.Read(address, bytes, length);
+                return ToHex(bytes, length);
+            }
+            if (*end != ':' || !FromHex(end + 1, bytes, length)) return "E01";
+            emulator.memory.Write(address, bytes, length);
+            return "OK";
+        }
+
+        case 'Z':
+        case 'z': {
+            bool insert = packet[0] == 'Z';
+            char* end;
+            int type = (int)std::strtol(args, &end, 10);
+            if (*end != ',') return "E01";
+            uint16_t address = (uint16_t)std::strtoul(end + 1, &end, 16);
+            unsigned long length = 1;
+            if (*end == ',') length = std::strtoul(end + 1, nullptr, 16);
+
+            switch (type) {
+                case 0:
+                case 1:
+                    if (insert) breakpoints.SetBreakpoint(address);
+                    else breakpoints.ClearBreakpoint(address);
+                    return "OK";
+                case 2:
+                case 3:
+                case 4:
+                    for (unsigned long i = 0; i < std::max(length, 1ul); ++i) {
+                        uint16_t watched = (uint16_t)(address + i);
+                        bool onRead = breakpoints.IsReadWatched(watched);
+                        bool onWrite = breakpoints.IsWriteWatched(watched);
+                        if (type != 3) onWrite = insert;
+                        if (type != 2) onRead = insert;
+                        breakpoints.SetWatch(watched, onRead, onWrite);
+                    }
+                    return "OK";
+                default:
+                    return "";
+            }
+        }
+
+        case 's':
+            // Optional resume address
+            if (*args) emulator.program_counter = (uint16_t)(std::strtoul(args, nullptr, 16) & 0xFFF);
+            running = true;
+            reply = false;
+            commands.Push(DebugCommandType::Step);
+            return "";
+
+        case 'b':
+            // Reverse step through the undo log
+            if (packet != "bs") return "";
+            running = true;
+            reply = false;
+            commands.Push(DebugCommandType::StepBack);
+            return "";
+
+        case 'c':
+            if (*args) emulator.program_counter = (uint16_t)(std::strtoul(args, nullptr, 16) & 0xFFF);
+            running = true;
+            reply = false;
+            commands.Push(DebugCommandType::Continue);
+            return "";
+
+        case 'k':
+            killRequested = true;
+            reply = false;
+            Disconnect();
+            return "";
+
+        case 'D':
+            SendPacket("OK");
+            reply = false;
+            Disconnect();
+            commands.Push(DebugCommandType::Continue);
+            return "";
+
+        case 'H':
+            return "OK";
+
+        case 'q':
+            if (packet.compare(0, 10, "qSupported") == 0) return "PacketSize=1000;swbreak+;ReverseStep+";
+            if (packet == "qAttached") return "1";
+            if (packet == "qC") return "QC1";
+            if (packet == "qfThreadInfo") return "m1";
+            if (packet == "qsThreadInfo") return "l";
+            return "";
+
+        default:
+            // Empty reply: not supported
+            return "";
+    }
+}
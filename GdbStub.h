@@ -0,0 +1,66 @@
+#ifndef GDBSTUB_H
+#define GDBSTUB_H
+
+#include <cstdint>
+#include <string>
+
+class chip8;
+class Breakpoints;
+class DebugCommandQueue;
+
+// Debug stub speaking the GDB remote serial protocol over localhost TCP or a
+// Unix domain socket, for scripting headless instances. It is polled at frame
+// boundaries from the emulation loop, so the core never waits on the socket.
+//
+// Register layout for g/G/p/P (little endian): V0-VF (1 byte each, regs
+// 0-15), I (2 bytes, reg 16), PC (2, reg 17), SP (2, reg 18), DT (1, reg 19),
+// ST (1, reg 20). Breakpoints: Z0/Z1 execution, Z2 write, Z3 read, Z4 access;
+// bs steps back through the undo log when one is kept.
+class GdbStub {
+public:
+    GdbStub();
+    ~GdbStub();
+
+    // "1234" or "localhost:1234" for TCP, "unix:/path/to.sock" for a Unix socket
+    bool Listen(const std::string& address);
+    void Close();
+
+    bool IsListening() const { return listenSocket != INVALID; }
+    bool IsConnected() const { return clientSocket != INVALID; }
+    bool IsKillRequested() const { return killRequested; }
+
+    // Accept a client and serve every complete packet received so far. Run
+    // control (stop, step, continue) is queued on commands for the loop.
+    void Poll(chip8& emulator, Breakpoints& breakpoints, DebugCommandQueue& commands);
+
+    // The loop calls this whenever emulation is halted after a cycle; a client
+    // waiting on a continue or step gets its stop reply
+    void NotifyStopped(const chip8& emulator);
+
+    // Tell a waiting client the program has ended (runners with a frame budget)
+    void NotifyExited(int status);
+
+private:
+    typedef intptr_t Socket;
+    static const Socket INVALID = -1;
+
+    Socket listenSocket;
+    Socket clientSocket;
+    std::string unixPath;
+    std::string input;
+    std::string output;     // Replies the socket could not take yet
+    bool running;           // Client sent c or s and waits for a stop reply
+    bool killRequested;
+
+    bool OpenListener(const std::string& address);
+    void Accept(DebugCommandQueue& commands);
+    void Disconnect();
+    void SendRaw(const std::string& data);
+    void FlushOutput();
+    void SendPacket(const std::string& payload);
+    std::string HandlePacket(const std::string& packet, chip8& emulator, Breakpoints& breakpoints,
+                             DebugCommandQueue& commands, bool& reply);
+    std::string StopReply(const chip8& emulator) const;
+};
+
+#endif // GDBSTUB_H
@@ -0,0 +1,195 @@
+#include "GlyphAtlasSDL.h"
+#include <iostream>
+#include <algorithm>
+
+// Atlas width in pixels; height grows with the number of glyph rows
+const int ATLAS_WIDTH = 512;
+const int ATLAS_PADDING = 1;
+
+GlyphAtlasSDL::GlyphAtlasSDL()
+    : renderer(nullptr), texture(nullptr), glyphs{}, whiteU(0.0f), whiteV(0.0f), lineHeight(0.0f) {
+}
+
+GlyphAtlasSDL::~GlyphAtlasSDL() {
+    Destroy();
+}
+
+bool GlyphAtlasSDL::Build(SDL_Renderer* targetRenderer, TTF_Font* font) {
+    Destroy();
+
+    if (!targetRenderer || !font) {
+        return false;
+    }
+
+    renderer = targetRenderer;
+    lineHeight = (float)TTF_GetFontHeight(font);
+
+    // Rasterise every glyph in white; colour comes from the vertices
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* glyphSurfaces[GLYPH_COUNT] = {};
+    SDL_Rect placement[GLYPH_COUNT] = {};
+
+    // Reserve a small white block at the origin for solid rectangles
+    int penX = 4 + ATLAS_PADDING;
+    int penY = 0;
+    int rowHeight = 4;
+
+    for (int i = 0; i < GLYPH_COUNT; ++i) {
+        glyphSurfaces[i] = TTF_RenderGlyph_Blended(font, (Uint32)(FIRST_GLYPH + i), white);
+        if (!glyphSurfaces[i]) {
+            continue;
+        }
+
+        int w = glyphSurfaces[i]->w;
+        int h = glyphSurfaces[i]->h;
+        if (penX + w > ATLAS_WIDTH) {
+            penX = 0;
+            penY += rowHeight + ATLAS_PADDING;
+            rowHeight = 0;
+        }
+
+        placement[i] = {penX, penY, w, h};
+        penX += w + ATLAS_PADDING;
+        rowHeight = std::max(rowHeight, h);
+    }
+
+    int atlasHeight = penY + rowHeight;
+
+    SDL_Surface* atlas = SDL_CreateSurface(ATLAS_WIDTH, atlasHeight, SDL_PIXELFORMAT_RGBA32);
+    if (!atlas) {
+        std::cerr << "Failed to create glyph atlas surface: " << SDL_GetError() << std::endl;
+        for (SDL_Surface* surface : glyphSurfaces) {
+            if (surface) SDL_DestroySurface(surface);
+        }
+        return false;
+    }
+
+    SDL_FillSurfaceRect(atlas, nullptr, 0);
+    SDL_Rect whiteRect = {0, 0, 4, 4};
+    SDL_FillSurfaceRect(atlas, &whiteRect, 0xFFFFFFFF);
+
+    for (int i = 0; i < GLYPH_COUNT; ++i) {
+        int advance = 0;
+        if (!TTF_GetGlyphMetrics(font, (Uint32)(FIRST_GLYPH + i), nullptr, nullptr, nullptr, nullptr, &advance)) {
+            advance = placement[i].w;
+        }
+
+        Glyph& glyph = glyphs[i];
+        glyph.advance = (float)advance;
+
+        if (!glyphSurfaces[i]) {
+            continue;
+        }
+
+        // Copy coverage straight into the atlas instead of blending it
+        SDL_SetSurfaceBlendMode(glyphSurfaces[i], SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(glyphSurfaces[i], nullptr, atlas, &placement[i]);
+        SDL_DestroySurface(glyphSurfaces[i]);
+
+        glyph.u0 = (float)placement[i].x / (float)ATLAS_WIDTH;
+        glyph.v0 = (float)placement[i].y / (float)atlasHeight;
+        glyph.u1 = (float)(placement[i].x + placement[i].w) / (float)ATLAS_WIDTH;
+        glyph.v1 = (float)(placement[i].y + placement[i].h) / (float)atlasHeight;
+        glyph.width = (float)placement[i].w;
+        glyph.height = (float)placement[i].h;
+    }
+
+    whiteU = 2.0f / (float)ATLAS_WIDTH;
+    whiteV = 2.0f / (float)atlasHeight;
+
+    texture = SDL_CreateTextureFromSurface(renderer, atlas);
+    SDL_DestroySurface(atlas);
+
+    if (!texture) {
+        std::cerr << "Failed to create glyph atlas texture: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
+
+    vertices.reserve(4096 * 4);
+    indices.reserve(4096 * 6);
+    return true;
+}
+
+void GlyphAtlasSDL::Destroy() {
+    if (texture) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+
+    vertices.clear();
+    renderer = nullptr;
+}
+
+void GlyphAtlasSDL::AddQuad(float x, float y, float w, float h, float u0, float v0, float u1, float v1,
+                            const SDL_FColor& color) {
+    size_t quad = vertices.size() / 4;
+
+    vertices.push_back({{x, y}, color, {u0, v0}});
+    vertices.push_back({{x + w, y}, color, {u1, v0}});
+    vertices.push_back({{x + w, y + h}, color, {u1, v1}});
+    vertices.push_back({{x, y + h}, color, {u0, v1}});
+
+    // The index pattern never changes, so it is only ever extended
+    if (indices.size() < (quad + 1) * 6) {
+        int base = (int)quad * 4;
+        indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+    }
+}
+
+float GlyphAtlasSDL::AddText(const char* text, float x, float y, SDL_Color color) {
+    if (!texture || !text) {
+        return x;
+    }
+
+    SDL_FColor fcolor = {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
+
+    for (const char* c = text; *c; ++c) {
+        int index = (unsigned char)*c - FIRST_GLYPH;
+        if (index < 0 || index >= GLYPH_COUNT) {
+            index = '?' - FIRST_GLYPH;
+        }
+
+        const Glyph& glyph = glyphs[index];
+        if (*c != ' ' && glyph.width > 0.0f) {
+            AddQuad(x, y, glyph.width, glyph.height, glyph.u0, glyph.v0, glyph.u1, glyph.v1, fcolor);
+        }
+        x += glyph.advance;
+    }
+
+    return x;
+}
+
+void GlyphAtlasSDL::AddRect(const SDL_FRect& rect, SDL_Color color) {
+    if (!texture) {
+        return;
+    }
+
+    SDL_FColor fcolor = {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
+    AddQuad(rect.x, rect.y, rect.w, rect.h, whiteU, whiteV, whiteU, whiteV, fcolor);
+}
+
+float GlyphAtlasSDL::MeasureText(const char* text) const {
+    float width = 0.0f;
+    for (const char* c = text; c && *c; ++c) {
+        int index = (unsigned char)*c - FIRST_GLYPH;
+        if (index < 0 || index >= GLYPH_COUNT) {
+            index = '?' - FIRST_GLYPH;
+        }
+        width += glyphs[index].advance;
+    }
+    return width;
+}
+
+void GlyphAtlasSDL::Flush() {
+    if (!texture || vertices.empty()) {
+        vertices.clear();
+        return;
+    }
+
+    int quadCount = (int)(vertices.size() / 4);
+    SDL_RenderGeometry(renderer, texture, vertices.data(), (int)vertices.size(), indices.data(), quadCount * 6);
+    vertices.clear();
+}
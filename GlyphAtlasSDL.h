@@ -0,0 +1,54 @@
+#ifndef GLYPHATLASSDL_H
+#define GLYPHATLASSDL_H
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <vector>
+
+// Printable ASCII glyphs rasterised once into a single texture. Text (and
+// solid rectangles, through a white texel) is queued as quads and drawn with
+// one SDL_RenderGeometry call per Flush().
+class GlyphAtlasSDL {
+public:
+    GlyphAtlasSDL();
+    ~GlyphAtlasSDL();
+
+    bool Build(SDL_Renderer* renderer, TTF_Font* font);
+    void Destroy();
+
+    bool IsReady() const { return texture != nullptr; }
+
+    // Queue text at (x, y); returns the x position after the last glyph
+    float AddText(const char* text, float x, float y, SDL_Color color);
+    void AddRect(const SDL_FRect& rect, SDL_Color color);
+
+    float MeasureText(const char* text) const;
+    float GetLineHeight() const { return lineHeight; }
+
+    // Draw everything queued since the last flush
+    void Flush();
+
+private:
+    static const int FIRST_GLYPH = 32;
+    static const int LAST_GLYPH = 126;
+    static const int GLYPH_COUNT = LAST_GLYPH - FIRST_GLYPH + 1;
+
+    struct Glyph {
+        float u0, v0, u1, v1;   // Normalized texture coordinates
+        float width, height;    // Quad size in pixels
+        float advance;
+    };
+
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;
+    Glyph glyphs[GLYPH_COUNT];
+    float whiteU, whiteV;
+    float lineHeight;
+
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+    void AddQuad(float x, float y, float w, float h, float u0, float v0, float u1, float v1, const SDL_FColor& color);
+};
+
+#endif // GLYPHATLASSDL_H
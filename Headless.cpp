@@ -0,0 +1,262 @@
+// Headless runner: no window, audio or splash screen. Runs a ROM for a fixed
+// number of frames with scripted input and reports a hash of the final
+// framebuffer, for CI and batch machines without a display.
+#include "chip8.h"
+#include "Breakpoints.h"
+#include "DebugCommands.h"
+#include "UndoLog.h"
+#include "GdbStub.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Keypad state from a frame onwards
+struct InputChange {
+    uint64_t frame;
+    uint16_t keys;      // Bit k set = key k down
+};
+
+// Input file: one "<frame> <keymask>" per line, keymask in hex (e.g. "120 0x0010").
+// Blank lines and lines starting with '#' are ignored.
+static bool LoadInput(const char* filename, std::vector<InputChange>& changes) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open input file: " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string frame, mask;
+        if (!(fields >> frame >> mask)) {
+            std::cerr << filename << ":" << lineNumber << ": expected \"<frame> <keymask>\"" << std::endl;
+            return false;
+        }
+
+        try {
+            changes.push_back({std::stoull(frame), (uint16_t)std::stoul(mask, nullptr, 16)});
+        } catch (const std::exception&) {
+            std::cerr << filename << ":" << lineNumber << ": bad number" << std::endl;
+            return false;
+        }
+    }
+
+    std::stable_sort(changes.begin(), changes.end(),
+                     [](const InputChange& a, const InputChange& b) { return a.frame < b.frame; });
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <ROM> <Frames> [--input <file>] [--hash <file>] [--cycles-per-frame <n>] [--seed <n>] [--gdb <port|unix:path>]\n";
+        std::cerr << "  ROM: Path to the CHIP-8 ROM file\n";
+        std::cerr << "  Frames: Number of frames to run\n";
+        std::cerr << "  --input: Optional - keypad script, one \"<frame> <hex keymask>\" per line\n";
+        std::cerr << "  --hash: Optional - write the final framebuffer hash to a file ('-' for stdout only)\n";
+        std::cerr << "  --cycles-per-frame: Optional - instructions per frame (default 10)\n";
+        std::cerr << "  --seed: Optional - random number seed for CXNN (default 0, so runs are repeatable)\n";
+        std::cerr << "  --gdb: Optional - serve the GDB remote protocol, starting halted until a client continues\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    char const* romFilename = argv[1];
+    uint64_t frames = std::stoull(argv[2]);
+    char const* inputFilename = nullptr;
+    char const* hashFilename = nullptr;
+    unsigned int cyclesPerFrame = 10;
+    unsigned int seed = 0;
+    char const* gdbAddress = nullptr;
+
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--input" && i + 1 < argc) {
+            inputFilename = argv[++i];
+        } else if (arg == "--hash" && i + 1 < argc) {
+            hashFilename = argv[++i];
+        } else if (arg == "--cycles-per-frame" && i + 1 < argc) {
+            cyclesPerFrame = (unsigned int)std::stoul(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = (unsigned int)std::stoul(argv[++i], nullptr, 0);
+        } else if (arg == "--gdb" && i + 1 < argc) {
+            gdbAddress = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    std::vector<InputChange> input;
+    if (inputFilename && !LoadInput(inputFilename, input)) {
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Read the ROM here: the file overload of LoadROM() logs to stdout,
+    // which carries only the hash
+    std::ifstream file(romFilename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open ROM file: " << romFilename << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    chip8 chip8;
+    if (!chip8.LoadROM(rom.data(), rom.size())) {
+        std::exit(EXIT_FAILURE);
+    }
+    chip8.randGen.seed(seed);
+    chip8.log_unknown_opcodes = true;
+
+    Breakpoints breakpoints;
+    chip8.breakpoints = &breakpoints;
+
+    // Optional remote debugging, serviced between frames like in the SDL frontend
+    DebugCommandQueue debugCommands;
+    std::vector<DebugCommand> commands;
+    std::unique_ptr<GdbStub> gdbStub;
+    std::unique_ptr<UndoLog> undoLog;
+    bool paused = false;
+    int pendingSteps = 0;
+
+    if (gdbAddress) {
+        gdbStub = std::make_unique<GdbStub>();
+        if (!gdbStub->Listen(gdbAddress)) {
+            std::exit(EXIT_FAILURE);
+        }
+        undoLog = std::make_unique<UndoLog>();
+        paused = true;
+    }
+
+    size_t nextInput = 0;
+    unsigned int frameCycles = 0;
+
+    auto runCycle = [&]() {
+        if (undoLog) {
+            undoLog->Record(chip8);
+        }
+        chip8.emulateCycle();
+
+        if (chip8.break_reason == BreakReason::Breakpoint) {
+            // Stopped before executing anything
+            if (undoLog) undoLog->DropLast();
+        } else {
+            ++frameCycles;
+        }
+        if (chip8.break_reason != BreakReason::None) {
+            paused = true;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (chip8.frame_count < frames) {
+        if (gdbStub) {
+            gdbStub->Poll(chip8, breakpoints, debugCommands);
+            if (gdbStub->IsKillRequested()) {
+                break;
+            }
+
+            debugCommands.Drain(commands);
+            for (const DebugCommand& command : commands) {
+                switch (command.type) {
+                    case DebugCommandType::Pause:
+                        paused = true;
+                        break;
+                    case DebugCommandType::Continue:
+                        paused = false;
+                        pendingSteps = 0;
+                        chip8.resumeFromBreak();
+                        break;
+                    case DebugCommandType::Step:
+                        if (paused) ++pendingSteps;
+                        break;
+                    case DebugCommandType::StepBack:
+                        paused = true;
+                        pendingSteps = 0;
+                        if (undoLog->StepBack(chip8) && frameCycles > 0) --frameCycles;
+                        break;
+                    case DebugCommandType::ToggleBreakpoint:
+                        breakpoints.ToggleBreakpoint(command.address);
+                        break;
+                }
+            }
+        }
+
+        // Scripted keypad state for this frame
+        if (frameCycles == 0) {
+            while (nextInput < input.size() && input[nextInput].frame <= chip8.frame_count) {
+                for (int key = 0; key < 16; ++key) {
+                    chip8.keypad[key] = (input[nextInput].keys >> key) & 1;
+                }
+                ++nextInput;
+            }
+        }
+
+        if (!gdbStub) {
+            // Nothing can resume a break, so run whole frames at full speed
+            if (!chip8.emulateFrame(cyclesPerFrame)) {
+                std::cerr << "Stopped by a break at PC 0x" << std::hex << chip8.program_counter << std::dec << std::endl;
+                break;
+            }
+            continue;
+        }
+
+        // With a debugger attached, run at most one frame between polls
+        while (paused && pendingSteps > 0 && frameCycles < cyclesPerFrame) {
+            --pendingSteps;
+            chip8.resumeFromBreak();
+            runCycle();
+        }
+        while (!paused && frameCycles < cyclesPerFrame) {
+            runCycle();
+        }
+        if (frameCycles >= cyclesPerFrame) {
+            chip8.endFrame();
+            frameCycles = 0;
+        }
+
+        if (paused) {
+            gdbStub->NotifyStopped(chip8);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    if (gdbStub) {
+        gdbStub->NotifyExited(0);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)chip8.hashGraphics());
+    std::cout << hash << std::endl;
+    std::cerr << chip8.frame_count << " frames, " << chip8.cycle_count << " cycles in " << seconds << " s" << std::endl;
+
+    if (hashFilename && std::string(hashFilename) != "-") {
+        std::ofstream out(hashFilename);
+        if (!out.is_open()) {
+            std::cerr << "Failed to write hash file: " << hashFilename << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        out << hash << std::endl;
+    }
+
+    return 0;
+}
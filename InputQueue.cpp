@@ -0,0 +1,81 @@
+#include "InputQueue.h"
+#include <iostream>
+#include <algorithm>
+
+InputQueue::InputQueue()
+    : keyCycle{}, keyDown{}, minHoldCycles(4),
+      latencyCount(0), latencyTotalNs(0), latencyMinNs(UINT64_MAX), latencyMaxNs(0), latencyLastNs(0) {
+    pending.reserve(64);
+    unpresented.reserve(64);
+}
+
+void InputQueue::Push(uint8_t key, bool pressed, uint64_t arrivalNs, uint64_t currentCycle) {
+    key &= 0xF;
+
+    if (keyDown[key] == pressed) {
+        return;
+    }
+
+    // Changes to one key apply in order, and a release never lands before
+    // the press has been visible for minHoldCycles
+    uint64_t applyCycle = currentCycle;
+    if (!pressed) {
+        applyCycle = std::max(applyCycle, keyCycle[key] + minHoldCycles);
+    } else {
+        applyCycle = std::max(applyCycle, keyCycle[key] + 1);
+    }
+
+    keyCycle[key] = applyCycle;
+    keyDown[key] = pressed;
+    pending.push_back({key, pressed, arrivalNs, applyCycle});
+}
+
+void InputQueue::Apply(uint8_t* keypad, uint64_t cycle) {
+    if (pending.empty()) {
+        return;
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < pending.size(); ++i) {
+        const KeyEvent& event = pending[i];
+        if (event.applyCycle <= cycle) {
+            keypad[event.key] = event.pressed ? 1 : 0;
+            unpresented.push_back(event.arrivalNs);
+        } else {
+            pending[kept++] = event;
+        }
+    }
+    pending.resize(kept);
+}
+
+void InputQueue::Clear() {
+    pending.clear();
+    unpresented.clear();
+    std::fill(keyDown, keyDown + 16, false);
+}
+
+void InputQueue::OnPresent(uint64_t presentNs) {
+    for (uint64_t arrivalNs : unpresented) {
+        uint64_t latency = (presentNs > arrivalNs) ? presentNs - arrivalNs : 0;
+        ++latencyCount;
+        latencyTotalNs += latency;
+        latencyMinNs = std::min(latencyMinNs, latency);
+        latencyMaxNs = std::max(latencyMaxNs, latency);
+        latencyLastNs = latency;
+    }
+    unpresented.clear();
+}
+
+double InputQueue::GetAverageLatencyMs() const {
+    return latencyCount ? (double)latencyTotalNs / (double)latencyCount / 1e6 : 0.0;
+}
+
+void InputQueue::PrintLatencyReport() const {
+    if (latencyCount == 0) {
+        return;
+    }
+
+    std::cout << "Input latency (key to present) over " << latencyCount << " key changes: "
+              << "min " << GetMinLatencyMs() << " ms, avg " << GetAverageLatencyMs()
+              << " ms, max " << GetMaxLatencyMs() << " ms" << std::endl;
+}
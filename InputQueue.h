@@ -0,0 +1,54 @@
+#ifndef INPUTQUEUE_H
+#define INPUTQUEUE_H
+
+#include <cstdint>
+#include <vector>
+
+struct KeyEvent {
+    uint8_t key;            // CHIP-8 key 0x0-0xF
+    bool pressed;
+    uint64_t arrivalNs;     // Host timestamp of the key change
+    uint64_t applyCycle;    // Emulated cycle at which the change reaches the keypad
+};
+
+// Keypad changes stamped on arrival and applied to chip8::keypad at a defined
+// emulated cycle. A press is held for at least minHoldCycles cycles even if
+// it is released before the emulator gets to run, so short taps are never lost.
+// Also measures key-to-present latency for every applied change.
+class InputQueue {
+public:
+    InputQueue();
+
+    void SetMinimumHold(uint32_t cycles) { minHoldCycles = cycles; }
+
+    void Push(uint8_t key, bool pressed, uint64_t arrivalNs, uint64_t currentCycle);
+    void Apply(uint8_t* keypad, uint64_t cycle);
+    void Clear();
+
+    // Call right after a frame has been presented
+    void OnPresent(uint64_t presentNs);
+
+    uint64_t GetSampleCount() const { return latencyCount; }
+    double GetAverageLatencyMs() const;
+    double GetMinLatencyMs() const { return latencyCount ? latencyMinNs / 1e6 : 0.0; }
+    double GetMaxLatencyMs() const { return latencyMaxNs / 1e6; }
+    double GetLastLatencyMs() const { return latencyLastNs / 1e6; }
+    void PrintLatencyReport() const;
+
+private:
+    std::vector<KeyEvent> pending;
+    uint64_t keyCycle[16];          // Cycle of the last scheduled change per key
+    bool keyDown[16];               // Last scheduled state per key
+    uint32_t minHoldCycles;
+
+    // Arrival times of changes applied but not yet shown on screen
+    std::vector<uint64_t> unpresented;
+
+    uint64_t latencyCount;
+    uint64_t latencyTotalNs;
+    uint64_t latencyMinNs;
+    uint64_t latencyMaxNs;
+    uint64_t latencyLastNs;
+};
+
+#endif // INPUTQUEUE_H
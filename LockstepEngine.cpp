@@ -0,0 +1,429 @@
+#include "LockstepEngine.h"
+#include "chip8.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LOCKSTEP_SSE2 1
+#endif
+
+const unsigned int FONT_START = 0x50;
+
+static uint8_t ReverseBits(uint8_t b) {
+    b = (uint8_t)((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+    b = (uint8_t)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+    b = (uint8_t)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+    return b;
+}
+
+static uint64_t RotateLeft(uint64_t value, unsigned int shift) {
+    shift &= 63;
+    return shift ? (value << shift) | (value >> (64 - shift)) : value;
+}
+
+LockstepEngine::LockstepEngine(size_t laneCount)
+    : lanes(std::max<size_t>(laneCount, 1)), cycleCount(0), frameCount(0), vectorCycles(0), scalarCycles(0),
+      randByte(0, 255U) {
+    for (int r = 0; r < 16; ++r) {
+        v[r].assign(lanes, 0);
+        stack[r].assign(lanes, 0);
+    }
+    index.assign(lanes, 0);
+    pc.assign(lanes, 0x200);
+    sp.assign(lanes, 0);
+    delayTimer.assign(lanes, 0);
+    soundTimer.assign(lanes, 0);
+    keys.assign(lanes, 0);
+    memory.assign(4096 * lanes, 0);
+    display.assign(VIDEO_HEIGHT * lanes, 0);
+    randGen.resize(lanes);
+}
+
+bool LockstepEngine::LoadROM(const uint8_t* data, size_t size) {
+    // Start from exactly the state a fresh chip8 has (font included)
+    chip8 initial;
+    if (!initial.LoadROM(data, size)) {
+        return false;
+    }
+
+    for (unsigned int address = 0; address < 4096; ++address) {
+        std::memset(&memory[address * lanes], initial.memory[address], lanes);
+    }
+    for (int r = 0; r < 16; ++r) {
+        std::fill(v[r].begin(), v[r].end(), 0);
+        std::fill(stack[r].begin(), stack[r].end(), 0);
+    }
+    std::fill(index.begin(), index.end(), 0);
+    std::fill(pc.begin(), pc.end(), initial.program_counter);
+    std::fill(sp.begin(), sp.end(), 0);
+    std::fill(delayTimer.begin(), delayTimer.end(), 0);
+    std::fill(soundTimer.begin(), soundTimer.end(), 0);
+    std::fill(display.begin(), display.end(), 0);
+    cycleCount = frameCount = vectorCycles = scalarCycles = 0;
+    return true;
+}
+
+bool LockstepEngine::IsConverged(uint16_t& opcode) const {
+    uint16_t address = pc[0];
+    const uint8_t* high = &memory[(address & 0xFFF) * lanes];
+    const uint8_t* low = &memory[((address + 1) & 0xFFF) * lanes];
+    opcode = (uint16_t)(high[0] << 8 | low[0]);
+
+    size_t lane = 0;
+
+#ifdef LOCKSTEP_SSE2
+    // Eight lanes per compare: PCs as 16-bit words, opcode bytes widened to match
+    const __m128i wantPc = _mm_set1_epi16((short)address);
+    const __m128i wantHigh = _mm_set1_epi8((char)high[0]);
+    const __m128i wantLow = _mm_set1_epi8((char)low[0]);
+
+    for (; lane + 8 <= lanes; lane += 8) {
+        __m128i pcs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pc[lane]));
+        __m128i highs = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(high + lane));
+        __m128i lows = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(low + lane));
+
+        __m128i same = _mm_and_si128(_mm_cmpeq_epi8(highs, wantHigh), _mm_cmpeq_epi8(lows, wantLow));
+        if ((_mm_movemask_epi8(_mm_cmpeq_epi16(pcs, wantPc)) != 0xFFFF) ||
+            ((_mm_movemask_epi8(same) & 0xFF) != 0xFF)) {
+            return false;
+        }
+    }
+#endif
+
+    for (; lane < lanes; ++lane) {
+        if (pc[lane] != address || high[lane] != high[0] || low[lane] != low[0]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LockstepEngine::Run(uint64_t cycles) {
+    for (uint64_t c = 0; c < cycles; ++c) {
+        uint16_t opcode;
+        if (IsConverged(opcode)) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                pc[lane] += 2;
+            }
+            if (ExecuteVector(opcode)) {
+                ++vectorCycles;
+            } else {
+                // Decoded once, but still run lane by lane
+                for (size_t lane = 0; lane < lanes; ++lane) {
+                    ExecuteLane(lane, opcode);
+                }
+                ++scalarCycles;
+            }
+        } else {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                uint16_t laneOpcode = (uint16_t)(Memory(lane, pc[lane]) << 8 | Memory(lane, pc[lane] + 1u));
+                pc[lane] += 2;
+                ExecuteLane(lane, laneOpcode);
+            }
+            ++scalarCycles;
+        }
+
+        // Timers tick once per cycle, as in the core
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            delayTimer[lane] = (uint8_t)(delayTimer[lane] - (delayTimer[lane] > 0));
+            soundTimer[lane] = (uint8_t)(soundTimer[lane] - (soundTimer[lane] > 0));
+        }
+        ++cycleCount;
+    }
+}
+
+// Instructions that only touch registers, applied to all lanes at once.
+// Returns false for the ones left to ExecuteLane().
+bool LockstepEngine::ExecuteVector(uint16_t opcode) {
+    const unsigned int x = (opcode >> 8) & 0xF;
+    const unsigned int y = (opcode >> 4) & 0xF;
+    const uint8_t nn = (uint8_t)(opcode & 0xFF);
+    const uint16_t nnn = opcode & 0xFFF;
+    const size_t n = lanes;
+
+    uint8_t* vx = v[x].data();
+    const uint8_t* vy = v[y].data();
+    uint8_t* vf = v[0xF].data();
+    uint16_t* pcs = pc.data();
+
+    switch (opcode & 0xF000) {
+        case 0x1000:
+            std::fill(pc.begin(), pc.end(), nnn);
+            return true;
+
+        case 0x3000:
+            for (size_t i = 0; i < n; ++i) pcs[i] = (uint16_t)(pcs[i] + ((vx[i] == nn) << 1));
+            return true;
+
+        case 0x4000:
+            for (size_t i = 0; i < n; ++i) pcs[i] = (uint16_t)(pcs[i] + ((vx[i] != nn) << 1));
+            return true;
+
+        case 0x5000:
+            for (size_t i = 0; i < n; ++i) pcs[i] = (uint16_t)(pcs[i] + ((vx[i] == vy[i]) << 1));
+            return true;
+
+        case 0x9000:
+            for (size_t i = 0; i < n; ++i) pcs[i] = (uint16_t)(pcs[i] + ((vx[i] != vy[i]) << 1));
+            return true;
+
+        case 0x6000:
+            std::memset(vx, nn, n);
+            return true;
+
+        case 0x7000:
+            for (size_t i = 0; i < n; ++i) vx[i] = (uint8_t)(vx[i] + nn);
+            return true;
+
+        case 0x8000:
+            // Same statement order as the core, so VF as an operand behaves the same
+            switch (opcode & 0xF) {
+                case 0x0:
+                    for (size_t i = 0; i < n; ++i) vx[i] = vy[i];
+                    return true;
+                case 0x1:
+                    for (size_t i = 0; i < n; ++i) vx[i] |= vy[i];
+                    return true;
+                case 0x2:
+                    for (size_t i = 0; i < n; ++i) vx[i] &= vy[i];
+                    return true;
+                case 0x3:
+                    for (size_t i = 0; i < n; ++i) vx[i] ^= vy[i];
+                    return true;
+                case 0x4:
+                    for (size_t i = 0; i < n; ++i) {
+                        unsigned int sum = vx[i] + vy[i];
+                        vf[i] = (uint8_t)(sum > 255);
+                        vx[i] = (uint8_t)sum;
+                    }
+                    return true;
+                case 0x5:
+                    for (size_t i = 0; i < n; ++i) {
+                        vf[i] = (uint8_t)(vx[i] >= vy[i]);
+                        vx[i] = (uint8_t)(vx[i] - vy[i]);
+                    }
+                    return true;
+                case 0x6:
+                    for (size_t i = 0; i < n; ++i) {
+                        vf[i] = vx[i] & 1;
+                        vx[i] = (uint8_t)(vx[i] >> 1);
+                    }
+                    return true;
+                case 0x7:
+                    for (size_t i = 0; i < n; ++i) {
+                        vf[i] = (uint8_t)(vy[i] >= vx[i]);
+                        vx[i] = (uint8_t)(vy[i] - vx[i]);
+                    }
+                    return true;
+                case 0xE:
+                    for (size_t i = 0; i < n; ++i) {
+                        vf[i] = (uint8_t)(vx[i] >> 7);
+                        vx[i] = (uint8_t)(vx[i] << 1);
+                    }
+                    return true;
+                default:
+                    return true;    // Unknown, ignored like the core does
+            }
+
+        case 0xA000:
+            std::fill(index.begin(), index.end(), nnn);
+            return true;
+
+        case 0xF000:
+            switch (nn) {
+                case 0x07:
+                    for (size_t i = 0; i < n; ++i) vx[i] = delayTimer[i];
+                    return true;
+                case 0x15:
+                    for (size_t i = 0; i < n; ++i) delayTimer[i] = vx[i];
+                    return true;
+                case 0x18:
+                    for (size_t i = 0; i < n; ++i) soundTimer[i] = vx[i];
+                    return true;
+                case 0x1E:
+                    for (size_t i = 0; i < n; ++i) index[i] = (uint16_t)(index[i] + vx[i]);
+                    return true;
+                case 0x29:
+                    for (size_t i = 0; i < n; ++i) index[i] = (uint16_t)(FONT_START + vx[i] * 5);
+                    return true;
+                default:
+                    return false;
+            }
+
+        default:
+            return false;
+    }
+}
+
+// One instruction for one lane; PC has already moved past it
+void LockstepEngine::ExecuteLane(size_t lane, uint16_t opcode) {
+    const unsigned int x = (opcode >> 8) & 0xF;
+    const unsigned int y = (opcode >> 4) & 0xF;
+    const uint8_t nn = (uint8_t)(opcode & 0xFF);
+    const uint16_t nnn = opcode & 0xFFF;
+
+    uint8_t& vx = v[x][lane];
+    const uint8_t& vy = v[y][lane];
+    uint8_t& vf = v[0xF][lane];
+    uint16_t& programCounter = pc[lane];
+
+    switch (opcode & 0xF000) {
+        case 0x0000:
+            if (nn == 0xE0) {
+                for (unsigned int row = 0; row < VIDEO_HEIGHT; ++row) {
+                    display[row * lanes + lane] = 0;
+                }
+            } else if (nn == 0xEE && sp[lane] > 0) {
+                programCounter = stack[--sp[lane]][lane];
+            }
+            break;
+
+        case 0x1000:
+            programCounter = nnn;
+            break;
+
+        case 0x2000:
+            if (sp[lane] < 16) {
+                stack[sp[lane]++][lane] = programCounter;
+                programCounter = nnn;
+            }
+            break;
+
+        case 0x3000: if (vx == nn) programCounter += 2; break;
+        case 0x4000: if (vx != nn) programCounter += 2; break;
+        case 0x5000: if (vx == vy) programCounter += 2; break;
+        case 0x9000: if (vx != vy) programCounter += 2; break;
+        case 0x6000: vx = nn; break;
+        case 0x7000: vx = (uint8_t)(vx + nn); break;
+
+        case 0x8000:
+            switch (opcode & 0xF) {
+                case 0x0: vx = vy; break;
+                case 0x1: vx |= vy; break;
+                case 0x2: vx &= vy; break;
+                case 0x3: vx ^= vy; break;
+                case 0x4: {
+                    unsigned int sum = vx + vy;
+                    vf = (uint8_t)(sum > 255);
+                    vx = (uint8_t)sum;
+                    break;
+                }
+                case 0x5:
+                    vf = (uint8_t)(vx >= vy);
+                    vx = (uint8_t)(vx - vy);
+                    break;
+                case 0x6:
+                    vf = vx & 1;
+                    vx = (uint8_t)(vx >> 1);
+                    break;
+                case 0x7:
+                    vf = (uint8_t)(vy >= vx);
+                    vx = (uint8_t)(vy - vx);
+                    break;
+                case 0xE:
+                    vf = (uint8_t)(vx >> 7);
+                    vx = (uint8_t)(vx << 1);
+                    break;
+            }
+            break;
+
+        case 0xA000: index[lane] = nnn; break;
+        case 0xB000: programCounter = (uint16_t)(nnn + v[0][lane]); break;
+        case 0xC000: vx = (uint8_t)(randByte(randGen[lane]) & nn); break;
+
+        case 0xD000: {
+            unsigned int px = vx, py = vy;
+            unsigned int height = opcode & 0xF;
+            vf = 0;
+
+            for (unsigned int row = 0; row < height; ++row) {
+                uint8_t sprite = Memory(lane, index[lane] + row);
+                if (!sprite) continue;
+
+                // Sprite column c lands on pixel (x + c) % 64, i.e. bit (x + c) & 63
+                uint64_t bits = RotateLeft(ReverseBits(sprite), px);
+                uint64_t& line = display[((py + row) % VIDEO_HEIGHT) * lanes + lane];
+                if (line & bits) vf = 1;
+                line ^= bits;
+            }
+            break;
+        }
+
+        case 0xE000:
+            if (nn == 0x9E && ((keys[lane] >> (vx & 0xF)) & 1)) programCounter += 2;
+            else if (nn == 0xA1 && !((keys[lane] >> (vx & 0xF)) & 1)) programCounter += 2;
+            break;
+
+        case 0xF000:
+            switch (nn) {
+                case 0x07: vx = delayTimer[lane]; break;
+                case 0x0A:
+                    if (keys[lane]) {
+                        unsigned int key = 0;
+                        while (!((keys[lane] >> key) & 1)) ++key;
+                        vx = (uint8_t)key;
+                    } else {
+                        programCounter -= 2;
+                    }
+                    break;
+                case 0x15: delayTimer[lane] = vx; break;
+                case 0x18: soundTimer[lane] = vx; break;
+                case 0x1E: index[lane] = (uint16_t)(index[lane] + vx); break;
+                case 0x29: index[lane] = (uint16_t)(FONT_START + vx * 5); break;
+                case 0x33:
+                    Memory(lane, index[lane]) = vx / 100;
+                    Memory(lane, index[lane] + 1u) = (vx / 10) % 10;
+                    Memory(lane, index[lane] + 2u) = vx % 10;
+                    break;
+                case 0x55:
+                    for (unsigned int i = 0; i <= x; ++i) Memory(lane, index[lane] + i) = v[i][lane];
+                    break;
+                case 0x65:
+                    for (unsigned int i = 0; i <= x; ++i) v[i][lane] = Memory(lane, index[lane] + i);
+                    break;
+            }
+            break;
+    }
+}
+
+uint64_t LockstepEngine::HashGraphics(size_t lane) const {
+    // FNV-1a over the pixels as chip8 stores them (32-bit, 0 or 0xFFFFFFFF)
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned int row = 0; row < VIDEO_HEIGHT; ++row) {
+        uint64_t line = display[row * lanes + lane];
+        for (unsigned int col = 0; col < VIDEO_WIDTH; ++col) {
+            uint8_t byte = ((line >> col) & 1) ? 0xFF : 0x00;
+            for (int b = 0; b < 4; ++b) {
+                hash = (hash ^ byte) * 1099511628211ull;
+            }
+        }
+    }
+    return hash;
+}
+
+void LockstepEngine::ExportLane(size_t lane, chip8& out) const {
+    for (unsigned int address = 0; address < 4096; ++address) {
+        out.memory.Write(address, Memory(lane, address));
+    }
+    for (int r = 0; r < 16; ++r) {
+        out.registers_V[r] = v[r][lane];
+        out.stack[r] = stack[r][lane];
+        out.keypad[r] = (keys[lane] >> r) & 1;
+    }
+    uint32_t* pixels = out.graphics.Writable();
+    for (unsigned int row = 0; row < VIDEO_HEIGHT; ++row) {
+        uint64_t line = display[row * lanes + lane];
+        for (unsigned int col = 0; col < VIDEO_WIDTH; ++col) {
+            pixels[row * VIDEO_WIDTH + col] = ((line >> col) & 1) ? 0xFFFFFFFF : 0;
+        }
+    }
+    out.index_register = index[lane];
+    out.program_counter = pc[lane];
+    out.stack_pointer = sp[lane];
+    out.delay_timer = delayTimer[lane];
+    out.sound_timer = soundTimer[lane];
+    out.cycle_count = cycleCount;
+    out.frame_count = frameCount;
+    out.randGen = randGen[lane];
+}
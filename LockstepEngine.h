@@ -0,0 +1,78 @@
+#ifndef LOCKSTEPENGINE_H
+#define LOCKSTEPENGINE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <random>
+#include <vector>
+#include "chip8.h"
+
+// Many instances of one ROM stored structure-of-arrays: each register is an
+// array with one entry per lane, memory is interleaved (address-major, so one
+// address across all lanes is contiguous) and the display is packed into one
+// 64-bit word per row. A lane costs about 4.5 KB instead of a chip8's 12 KB.
+//
+// Every cycle checks whether all lanes are at the same PC with the same
+// opcode. If so the instruction is decoded once and applied to every lane in
+// loops the compiler turns into SIMD code; otherwise (or for instructions
+// with per-lane memory addressing, such as DXYN) lanes run one at a time.
+//
+// Instructions behave like chip8::emulateCycle(), except that keypad indices
+// wrap at 16 instead of running off the end.
+class LockstepEngine {
+public:
+    explicit LockstepEngine(size_t laneCount);
+
+    size_t GetLaneCount() const { return lanes; }
+
+    // Same ROM (and reset state) in every lane
+    bool LoadROM(const uint8_t* data, size_t size);
+
+    void Seed(size_t lane, uint32_t seed) { randGen[lane].seed(seed); }
+    void SetKeys(size_t lane, uint16_t mask) { keys[lane] = mask; }
+
+    void Run(uint64_t cycles);
+    void RunFrame(unsigned int cycles) { Run(cycles); ++frameCount; }
+
+    uint64_t GetCycleCount() const { return cycleCount; }
+    uint64_t GetFrameCount() const { return frameCount; }
+
+    // Converged cycles run once for all lanes vs. cycles run lane by lane
+    uint64_t GetVectorCycles() const { return vectorCycles; }
+    uint64_t GetScalarCycles() const { return scalarCycles; }
+
+    // Same value chip8::hashGraphics() gives for an identical display
+    uint64_t HashGraphics(size_t lane) const;
+
+    // Expand one lane into a chip8 for inspection or to continue alone
+    void ExportLane(size_t lane, chip8& out) const;
+
+private:
+    size_t lanes;
+    uint64_t cycleCount;
+    uint64_t frameCount;
+    uint64_t vectorCycles;
+    uint64_t scalarCycles;
+
+    std::vector<uint8_t> v[16];
+    std::vector<uint16_t> index;
+    std::vector<uint16_t> pc;
+    std::vector<uint16_t> sp;
+    std::vector<uint16_t> stack[16];
+    std::vector<uint8_t> delayTimer;
+    std::vector<uint8_t> soundTimer;
+    std::vector<uint16_t> keys;             // Bit k set = key k down
+    std::vector<uint8_t> memory;            // memory[address * lanes + lane]
+    std::vector<uint64_t> display;          // display[row * lanes + lane], bit x = pixel x
+    std::vector<std::default_random_engine> randGen;
+    RandByteDistribution randByte;
+
+    uint8_t& Memory(size_t lane, unsigned int address) { return memory[(address & 0xFFF) * lanes + lane]; }
+    uint8_t Memory(size_t lane, unsigned int address) const { return memory[(address & 0xFFF) * lanes + lane]; }
+
+    bool IsConverged(uint16_t& opcode) const;
+    bool ExecuteVector(uint16_t opcode);
+    void ExecuteLane(size_t lane, uint16_t opcode);
+};
+
+#endif // LOCKSTEPENGINE_H
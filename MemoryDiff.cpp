@@ -0,0 +1,70 @@
+#include "MemoryDiff.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MEMORYDIFF_SSE2 1
+#endif
+
+MemoryDiff::MemoryDiff() : primed(false) {
+    changed.reserve(SIZE);
+    Reset();
+}
+
+void MemoryDiff::Reset() {
+    std::memset(shadow, 0, sizeof(shadow));
+    std::memset(age, NEVER, sizeof(age));
+    changed.clear();
+    primed = false;
+}
+
+void MemoryDiff::Update(const uint8_t* memory) {
+    changed.clear();
+
+    if (!primed) {
+        std::memcpy(shadow, memory, SIZE);
+        primed = true;
+        return;
+    }
+
+#ifdef MEMORYDIFF_SSE2
+    const __m128i one = _mm_set1_epi8(1);
+
+    for (int block = 0; block < SIZE; block += 16) {
+        __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(memory + block));
+        __m128i previous = _mm_load_si128(reinterpret_cast<const __m128i*>(shadow + block));
+        __m128i ages = _mm_load_si128(reinterpret_cast<const __m128i*>(age + block));
+
+        // Everything gets one frame older; changed bytes restart at zero
+        __m128i same = _mm_cmpeq_epi8(current, previous);
+        ages = _mm_and_si128(_mm_adds_epu8(ages, one), same);
+        _mm_store_si128(reinterpret_cast<__m128i*>(age + block), ages);
+
+        unsigned int diff = ~(unsigned int)_mm_movemask_epi8(same) & 0xFFFF;
+        if (diff) {
+            _mm_store_si128(reinterpret_cast<__m128i*>(shadow + block), current);
+            for (int i = 0; i < 16; ++i) {
+                if (diff & (1u << i)) changed.push_back((uint16_t)(block + i));
+            }
+        }
+    }
+#else
+    for (int block = 0; block < SIZE; block += 16) {
+        for (int i = block; i < block + 16; ++i) {
+            if (age[i] != NEVER) ++age[i];
+        }
+
+        if (std::memcmp(memory + block, shadow + block, 16) == 0) {
+            continue;
+        }
+
+        for (int i = block; i < block + 16; ++i) {
+            if (memory[i] != shadow[i]) {
+                shadow[i] = memory[i];
+                age[i] = 0;
+                changed.push_back((uint16_t)i);
+            }
+        }
+    }
+#endif
+}
@@ -0,0 +1,34 @@
+#ifndef MEMORYDIFF_H
+#define MEMORYDIFF_H
+
+#include <cstdint>
+#include <vector>
+
+// Frame-to-frame diff of the 4 KB memory against a shadow copy, 16 bytes per
+// compare where SSE2 is available. Every byte carries an age: 0 when it
+// changed in the latest update, counting up (saturating) afterwards.
+class MemoryDiff {
+public:
+    static const int SIZE = 4096;
+    static const uint8_t NEVER = 255;
+
+    MemoryDiff();
+
+    // Compare against the previous call; the first call only primes the shadow
+    void Update(const uint8_t* memory);
+    void Reset();
+
+    uint8_t GetAge(uint16_t address) const { return age[address & (SIZE - 1)]; }
+    const uint8_t* GetAges() const { return age; }
+
+    // Addresses that changed in the latest update, ascending
+    const std::vector<uint16_t>& GetChanged() const { return changed; }
+
+private:
+    alignas(16) uint8_t shadow[SIZE];
+    alignas(16) uint8_t age[SIZE];
+    std::vector<uint16_t> changed;
+    bool primed;
+};
+
+#endif // MEMORYDIFF_H
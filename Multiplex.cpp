@@ -0,0 +1,103 @@
+// Runs many instances of one ROM on a single thread with CoroutineScheduler.
+// Each instance suspends at its own events; a key wait is answered by
+// pressing a key for one frame, so menu screens don't stall the run.
+#include "chip8.h"
+#include "CoroutineScheduler.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <ROM> <Instances> <Frames> [--cycles-per-frame <n>] [--slice <n>] [--key <k>]\n";
+        std::cerr << "  ROM: Path to the CHIP-8 ROM file\n";
+        std::cerr << "  Instances: Number of emulators, seeded 0, 1, 2...\n";
+        std::cerr << "  Frames: Frames to run each instance for\n";
+        std::cerr << "  --cycles-per-frame: Optional - instructions per frame (default 10)\n";
+        std::cerr << "  --slice: Optional - most instructions an instance runs per turn (default: up to a frame)\n";
+        std::cerr << "  --key: Optional - key (hex) pressed for a frame when an instance waits for one (default 5)\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    char const* romFilename = argv[1];
+    size_t instanceCount = std::stoul(argv[2]);
+    uint64_t frames = std::stoull(argv[3]);
+    unsigned int cyclesPerFrame = 10;
+    uint64_t slice = 0;
+    unsigned int answerKey = 5;
+
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--cycles-per-frame" && i + 1 < argc) {
+            cyclesPerFrame = (unsigned int)std::stoul(argv[++i]);
+        } else if (arg == "--slice" && i + 1 < argc) {
+            slice = std::stoull(argv[++i]);
+        } else if (arg == "--key" && i + 1 < argc) {
+            answerKey = (unsigned int)std::stoul(argv[++i], nullptr, 16) & 0x0F;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    std::ifstream file(romFilename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open ROM file: " << romFilename << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::vector<chip8> emulators(instanceCount);
+    CoroutineScheduler scheduler(cyclesPerFrame, slice);
+    for (size_t i = 0; i < instanceCount; ++i) {
+        if (!emulators[i].LoadROM(rom.data(), rom.size())) {
+            std::exit(EXIT_FAILURE);
+        }
+        emulators[i].randGen.seed((unsigned int)i);
+        scheduler.Add(emulators[i]);
+    }
+
+    uint64_t stops[5] = {};
+    auto start = std::chrono::steady_clock::now();
+
+    scheduler.Run([&](size_t, chip8& emulator, StopReason reason) {
+        ++stops[(int)reason];
+        switch (reason) {
+            case StopReason::KeyWait:
+                emulator.keypad[answerKey] = 1;
+                break;
+            case StopReason::FrameEnd:
+                emulator.keypad[answerKey] = 0;
+                return emulator.frame_count < frames;
+            default:
+                break;
+        }
+        return true;
+    });
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t cycles = 0;
+    for (const chip8& emulator : emulators) {
+        cycles += emulator.cycle_count;
+    }
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", instanceCount ? (unsigned long long)emulators[0].hashGraphics() : 0ull);
+    std::cout << hash << std::endl;
+    std::cerr << instanceCount << " instances on one thread in " << seconds << " s ("
+              << (seconds > 0.0 ? cycles / seconds / 1e6 : 0.0) << " M instructions/s, "
+              << scheduler.GetResumeCount() << " resumes)" << std::endl;
+    std::cerr << "stops: " << stops[(int)StopReason::FrameEnd] << " frame, " << stops[(int)StopReason::KeyWait]
+              << " key wait, " << stops[(int)StopReason::SoundStart] << " sound, "
+              << stops[(int)StopReason::Budget] << " budget" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,224 @@
+// Netplay runner: one player of a two-player rollback session, headless, with
+// scripted input. Start one process per player with mirrored addresses; both
+// print the same final framebuffer hash unless they desynced.
+#include "chip8.h"
+#include "RollbackSession.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Keypad state from a frame onwards
+struct InputChange {
+    uint64_t frame;
+    uint16_t keys;      // Bit k set = key k down
+};
+
+// Same format as chip8_headless --input: one "<frame> <keymask>" per line,
+// keymask in hex. Blank lines and lines starting with '#' are ignored.
+static bool LoadInput(const char* filename, std::vector<InputChange>& changes) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open input file: " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string frame, mask;
+        if (!(fields >> frame >> mask)) {
+            std::cerr << filename << ":" << lineNumber << ": expected \"<frame> <keymask>\"" << std::endl;
+            return false;
+        }
+
+        try {
+            changes.push_back({std::stoull(frame), (uint16_t)std::stoul(mask, nullptr, 16)});
+        } catch (const std::exception&) {
+            std::cerr << filename << ":" << lineNumber << ": bad number" << std::endl;
+            return false;
+        }
+    }
+
+    std::stable_sort(changes.begin(), changes.end(),
+                     [](const InputChange& a, const InputChange& b) { return a.frame < b.frame; });
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <ROM> <Frames> --local <[host:]port> --peer <host:port> [--input <file>] [--cycles-per-frame <n>] [--seed <n>] [--fps <n>] [--max-rollback <frames>] [--loss <percent>]\n";
+        std::cerr << "  ROM: Path to the CHIP-8 ROM file (both players need the same one)\n";
+        std::cerr << "  Frames: Number of frames to play\n";
+        std::cerr << "  --local: UDP port to receive on (loopback unless a host is given)\n";
+        std::cerr << "  --peer: The other player's address\n";
+        std::cerr << "  --input: Optional - this player's keypad script, one \"<frame> <hex keymask>\" per line\n";
+        std::cerr << "  --cycles-per-frame: Optional - instructions per frame (default 10)\n";
+        std::cerr << "  --seed: Optional - random number seed for CXNN, must match the peer (default 0)\n";
+        std::cerr << "  --fps: Optional - frames per second, 0 to run as fast as the peer allows (default 60)\n";
+        std::cerr << "  --max-rollback: Optional - frames to run ahead of the peer's input (default 8)\n";
+        std::cerr << "  --loss: Optional - drop this percentage of outgoing packets, for testing\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    char const* romFilename = argv[1];
+    uint32_t frames = (uint32_t)std::stoul(argv[2]);
+    std::string localAddress;
+    std::string peerAddress;
+    char const* inputFilename = nullptr;
+    unsigned int cyclesPerFrame = 10;
+    unsigned int seed = 0;
+    double fps = 60.0;
+    unsigned int maxRollback = 8;
+    double loss = 0.0;
+
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--local" && i + 1 < argc) {
+            localAddress = argv[++i];
+        } else if (arg == "--peer" && i + 1 < argc) {
+            peerAddress = argv[++i];
+        } else if (arg == "--input" && i + 1 < argc) {
+            inputFilename = argv[++i];
+        } else if (arg == "--cycles-per-frame" && i + 1 < argc) {
+            cyclesPerFrame = (unsigned int)std::stoul(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = (unsigned int)std::stoul(argv[++i], nullptr, 0);
+        } else if (arg == "--fps" && i + 1 < argc) {
+            fps = std::stod(argv[++i]);
+        } else if (arg == "--max-rollback" && i + 1 < argc) {
+            maxRollback = (unsigned int)std::stoul(argv[++i]);
+        } else if (arg == "--loss" && i + 1 < argc) {
+            loss = std::stod(argv[++i]) / 100.0;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    if (localAddress.empty() || peerAddress.empty()) {
+        std::cerr << "--local and --peer are required" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::vector<InputChange> input;
+    if (inputFilename && !LoadInput(inputFilename, input)) {
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::ifstream file(romFilename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open ROM file: " << romFilename << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    chip8 chip8;
+    if (!chip8.LoadROM(rom.data(), rom.size())) {
+        std::exit(EXIT_FAILURE);
+    }
+    chip8.randGen.seed(seed);
+
+    // Peers only talk if they agree on everything that affects the result
+    uint64_t sessionId = 14695981039346656037ull;
+    for (uint8_t byte : rom) {
+        sessionId = (sessionId ^ byte) * 1099511628211ull;
+    }
+    sessionId = (sessionId ^ seed) * 1099511628211ull;
+    sessionId = (sessionId ^ cyclesPerFrame) * 1099511628211ull;
+
+    RollbackSession session(chip8, cyclesPerFrame, maxRollback);
+    session.SetPacketLoss(loss);
+    if (!session.Open(localAddress, peerAddress, sessionId)) {
+        std::exit(EXIT_FAILURE);
+    }
+
+    const double TIMEOUT_MS = 5000.0;
+    auto frameTime = std::chrono::duration<double>(fps > 0.0 ? 1.0 / fps : 0.0);
+    auto start = std::chrono::steady_clock::now();
+    auto nextFrame = start;
+    size_t nextInput = 0;
+    uint16_t keys = 0;
+    uint64_t stalls = 0;
+
+    while (session.GetFrame() < frames) {
+        session.Poll();
+        if (session.GetSilenceMs() > TIMEOUT_MS) {
+            std::cerr << "Netplay: no packets from the peer for " << TIMEOUT_MS / 1000.0 << " s, giving up" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (fps > 0.0 && now < nextFrame) {
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                nextFrame - now, std::chrono::milliseconds(1)));
+            continue;
+        }
+
+        while (nextInput < input.size() && input[nextInput].frame <= session.GetFrame()) {
+            keys = input[nextInput].keys;
+            ++nextInput;
+        }
+
+        if (session.AdvanceFrame(keys)) {
+            nextFrame += std::chrono::duration_cast<std::chrono::steady_clock::duration>(frameTime);
+            // Don't try to catch up after a long stall
+            if (now - nextFrame > std::chrono::milliseconds(100)) {
+                nextFrame = now;
+            }
+        } else {
+            ++stalls;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Wait until every frame's input is final on both sides, then keep
+    // answering briefly so the peer gets our last acknowledgement
+    while (!session.IsSettled(frames)) {
+        session.Poll();
+        if (session.GetSilenceMs() > TIMEOUT_MS) {
+            std::cerr << "Netplay: peer left before the last frames were confirmed" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto linger = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+    while (std::chrono::steady_clock::now() < linger) {
+        session.Poll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)chip8.hashGraphics());
+    std::cout << hash << std::endl;
+
+    uint64_t resimulated = session.GetResimulatedFrames();
+    std::cerr << frames << " frames in " << seconds << " s, " << session.GetRollbackCount() << " rollbacks ("
+              << resimulated << " frames run again, "
+              << (resimulated ? session.GetResimulationMs() * 1000.0 / resimulated : 0.0) << " us per frame), "
+              << stalls << " stalls" << std::endl;
+
+    if (session.IsDesynced()) {
+        std::cerr << "Desynced by frame " << session.GetDesyncFrame() << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cerr << "In sync (" << session.GetConfirmedFrame() << " frames checked)" << std::endl;
+    return 0;
+}
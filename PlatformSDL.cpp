@@ -134,57 +134,60 @@ void PlatformSDL::Update(void const* buffer, int pitch) {
     SDL_RenderPresent(renderer);
 }
 
-bool PlatformSDL::ProcessInput(uint8_t* keys) {
-    SDL_Event e;
-
-    // Clear all keys first
-    for (int i = 0; i < 16; ++i) {
-        keys[i] = 0;
-    }
-
-    // Check for events
-    while (SDL_PollEvent(&e)) {
-        if (e.type == SDL_EVENT_QUIT) {
-            return true;
-        }
-
-        if (e.type == SDL_EVENT_KEY_DOWN) {
-            // SDL3: e.key.key instead of e.key.keysym.sym
-            if (e.key.key == SDLK_ESCAPE) {
-                return true;
-            }
-        }
-    }
-
-    // Get current keyboard state
-    const bool* keyState = SDL_GetKeyboardState(nullptr);
-
-    // Map keys to CHIP-8 keypad
+// Map a scancode to its CHIP-8 key, or -1 if it is not part of the keypad
+static int ScancodeToKey(SDL_Scancode scancode) {
     // CHIP-8 keypad layout:
     // 1 2 3 C
     // 4 5 6 D
     // 7 8 9 E
     // A 0 B F
+    switch (scancode) {
+        case SDL_SCANCODE_1: return 0x1;
+        case SDL_SCANCODE_2: return 0x2;
+        case SDL_SCANCODE_3: return 0x3;
+        case SDL_SCANCODE_4: return 0xC;
+
+        case SDL_SCANCODE_Q: return 0x4;
+        case SDL_SCANCODE_W: return 0x5;
+        case SDL_SCANCODE_E: return 0x6;
+        case SDL_SCANCODE_R: return 0xD;
+
+        case SDL_SCANCODE_A: return 0x7;
+        case SDL_SCANCODE_S: return 0x8;
+        case SDL_SCANCODE_D: return 0x9;
+        case SDL_SCANCODE_F: return 0xE;
+
+        case SDL_SCANCODE_Z: return 0xA;
+        case SDL_SCANCODE_X: return 0x0;
+        case SDL_SCANCODE_C: return 0xB;
+        case SDL_SCANCODE_V: return 0xF;
+
+        default: return -1;
+    }
+}
 
-    if (keyState[SDL_SCANCODE_1]) keys[0x1] = 1;
-    if (keyState[SDL_SCANCODE_2]) keys[0x2] = 1;
-    if (keyState[SDL_SCANCODE_3]) keys[0x3] = 1;
-    if (keyState[SDL_SCANCODE_4]) keys[0xC] = 1;
+bool PlatformSDL::HandleEvent(const SDL_Event& e, InputQueue& input, uint64_t currentCycle) {
+    if (e.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED) {
+        return true;
+    }
 
-    if (keyState[SDL_SCANCODE_Q]) keys[0x4] = 1;
-    if (keyState[SDL_SCANCODE_W]) keys[0x5] = 1;
-    if (keyState[SDL_SCANCODE_E]) keys[0x6] = 1;
-    if (keyState[SDL_SCANCODE_R]) keys[0xD] = 1;
+    // Every key change is queued with its event timestamp, so presses shorter
+    // than a loop iteration still reach the keypad
+    if (e.type == SDL_EVENT_KEY_DOWN || e.type == SDL_EVENT_KEY_UP) {
+        // SDL3: e.key.key instead of e.key.keysym.sym
+        if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_ESCAPE) {
+            return true;
+        }
 
-    if (keyState[SDL_SCANCODE_A]) keys[0x7] = 1;
-    if (keyState[SDL_SCANCODE_S]) keys[0x8] = 1;
-    if (keyState[SDL_SCANCODE_D]) keys[0x9] = 1;
-    if (keyState[SDL_SCANCODE_F]) keys[0xE] = 1;
+        if (e.key.repeat) {
+            return false;
+        }
 
-    if (keyState[SDL_SCANCODE_Z]) keys[0xA] = 1;
-    if (keyState[SDL_SCANCODE_X]) keys[0x0] = 1;
-    if (keyState[SDL_SCANCODE_C]) keys[0xB] = 1;
-    if (keyState[SDL_SCANCODE_V]) keys[0xF] = 1;
+        int key = ScancodeToKey(e.key.scancode);
+        if (key >= 0) {
+            input.Push((uint8_t)key, e.type == SDL_EVENT_KEY_DOWN, e.key.timestamp, currentCycle);
+        }
+    }
 
     return false;
-}
\ No newline at end of file
+}
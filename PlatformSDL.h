@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <SDL3/SDL.h>
+#include "InputQueue.h"
 
 class PlatformSDL {
 public:
@@ -14,7 +15,9 @@ public:
     ~PlatformSDL();
 
     void Update(void const* buffer, int pitch);
-    bool ProcessInput(uint8_t* keys);
+    bool HandleEvent(const SDL_Event& e, InputQueue& input, uint64_t currentCycle);
+
+    SDL_WindowID GetWindowID() const { return window ? SDL_GetWindowID(window) : 0; }
 
 private:
     SDL_Window* window;
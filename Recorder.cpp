@@ -0,0 +1,355 @@
+#include "Recorder.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+static uint64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Recorder::Recorder()
+    : head(0), tail(0), recording(false), stopRequested(false),
+      framesWritten(0), framesDropped(0), format(RecordFormat::GIF),
+      frameWidth(0), frameHeight(0), frameBytes(0), gifScale(1), startTimeMs(0),
+      pendingStartMs(0), lastEmitCs(0), hasPending(false) {
+}
+
+Recorder::~Recorder() {
+    Stop();
+}
+
+bool Recorder::Start(const char* filename, int width, int height, int scale) {
+    if (recording) {
+        return false;
+    }
+
+    if (width <= 0 || height <= 0 || width > (int)RECORDER_MAX_WIDTH || height > (int)RECORDER_MAX_HEIGHT) {
+        std::cerr << "Recorder: unsupported frame size " << width << "x" << height << std::endl;
+        return false;
+    }
+
+    outputPath = filename;
+    std::string lower = outputPath;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    format = (lower.size() >= 4 && lower.compare(lower.size() - 4, 4, ".gif") == 0)
+                 ? RecordFormat::GIF : RecordFormat::RAW;
+
+    out.open(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Recorder: failed to open output file: " << filename << std::endl;
+        return false;
+    }
+
+    frameWidth = width;
+    frameHeight = height;
+    frameBytes = (width * height + 7) / 8;
+    gifScale = std::max(1, std::min(scale, 16));
+
+    slots.assign(SLOT_COUNT, FrameSlot{});
+    head = 0;
+    tail = 0;
+    framesWritten = 0;
+    framesDropped = 0;
+
+    pendingFrame.assign(frameBytes, 0);
+    hasPending = false;
+    pendingStartMs = 0;
+    lastEmitCs = 0;
+
+    if (format == RecordFormat::GIF) {
+        indexBuffer.resize((size_t)width * gifScale * height * gifScale);
+        lzwTable.resize(4096 * 4);
+        WriteGifHeader();
+    } else {
+        WriteRawHeader();
+    }
+
+    startTimeMs = NowMs();
+    stopRequested = false;
+    recording = true;
+    encoderThread = std::thread(&Recorder::EncoderLoop, this);
+
+    std::cout << "Recording to " << filename
+              << (format == RecordFormat::GIF ? " (animated GIF)" : " (raw sequence)") << std::endl;
+    return true;
+}
+
+void Recorder::Stop() {
+    if (!recording) {
+        return;
+    }
+
+    recording = false;
+    stopRequested = true;
+    wakeSignal.notify_one();
+
+    if (encoderThread.joinable()) {
+        encoderThread.join();
+    }
+
+    if (format == RecordFormat::GIF) {
+        out.put(0x3B); // GIF trailer
+    }
+    out.close();
+
+    std::cout << "Recording saved: " << outputPath << " (" << framesWritten << " frames written, "
+              << framesDropped << " dropped)" << std::endl;
+}
+
+void Recorder::SubmitFrame(const uint32_t* pixels) {
+    if (!recording) {
+        return;
+    }
+
+    uint64_t h = head.load(std::memory_order_relaxed);
+    uint64_t t = tail.load(std::memory_order_acquire);
+
+    // Never wait for the encoder; if it fell behind, drop this frame
+    if (h - t >= SLOT_COUNT) {
+        framesDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    FrameSlot& slot = slots[h % SLOT_COUNT];
+    slot.timestampMs = NowMs() - startTimeMs;
+
+    // Pack to 1 bit per pixel directly in the slot, MSB first
+    std::memset(slot.bits, 0, frameBytes);
+    int pixelCount = frameWidth * frameHeight;
+    for (int i = 0; i < pixelCount; ++i) {
+        if (pixels[i] != 0) {
+            slot.bits[i >> 3] |= (uint8_t)(0x80 >> (i & 7));
+        }
+    }
+
+    head.store(h + 1, std::memory_order_release);
+
+    // Only wake the encoder when it may be idle
+    if (h == t) {
+        wakeSignal.notify_one();
+    }
+}
+
+void Recorder::EncoderLoop() {
+    while (true) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        uint64_t h = head.load(std::memory_order_acquire);
+
+        if (t == h) {
+            if (stopRequested) {
+                break;
+            }
+
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeSignal.wait_for(lock, std::chrono::milliseconds(10));
+            continue;
+        }
+
+        ConsumeFrame(slots[t % SLOT_COUNT]);
+        tail.store(t + 1, std::memory_order_release);
+    }
+
+    // Flush the last frame up to the moment recording stopped
+    if (hasPending) {
+        uint64_t endMs = NowMs() - startTimeMs;
+        if (format == RecordFormat::GIF && endMs / 10 < lastEmitCs + 2) {
+            endMs = (lastEmitCs + 2) * 10;
+        }
+        EmitPending(endMs);
+    }
+
+    out.flush();
+}
+
+void Recorder::ConsumeFrame(const FrameSlot& slot) {
+    if (!hasPending) {
+        std::memcpy(pendingFrame.data(), slot.bits, frameBytes);
+        pendingStartMs = slot.timestampMs;
+        hasPending = true;
+        return;
+    }
+
+    // Identical consecutive frames only extend the pending frame's duration
+    if (std::memcmp(pendingFrame.data(), slot.bits, frameBytes) == 0) {
+        return;
+    }
+
+    EmitPending(slot.timestampMs);
+
+    std::memcpy(pendingFrame.data(), slot.bits, frameBytes);
+    pendingStartMs = slot.timestampMs;
+}
+
+void Recorder::EmitPending(uint64_t endMs) {
+    if (format == RecordFormat::RAW) {
+        WriteRawFrame(pendingFrame.data(), (uint32_t)(endMs - pendingStartMs));
+        ++framesWritten;
+        return;
+    }
+
+    // GIF delays are in centiseconds and most viewers clamp anything below 2,
+    // so frames shorter than that are superseded by the next one
+    uint64_t endCs = endMs / 10;
+    if (endCs < lastEmitCs + 2) {
+        return;
+    }
+
+    WriteGifFrame(pendingFrame.data(), (uint16_t)std::min<uint64_t>(endCs - lastEmitCs, 65535));
+    lastEmitCs = endCs;
+    ++framesWritten;
+}
+
+void Recorder::WriteU16(uint16_t value) {
+    out.put((char)(value & 0xFF));
+    out.put((char)(value >> 8));
+}
+
+void Recorder::WriteU32(uint32_t value) {
+    WriteU16((uint16_t)(value & 0xFFFF));
+    WriteU16((uint16_t)(value >> 16));
+}
+
+void Recorder::WriteGifHeader() {
+    out.write("GIF89a", 6);
+
+    // Logical screen descriptor with a 2-entry global color table
+    WriteU16((uint16_t)(frameWidth * gifScale));
+    WriteU16((uint16_t)(frameHeight * gifScale));
+    out.put((char)0x80);
+    out.put(0);
+    out.put(0);
+
+    const uint8_t palette[6] = {0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF};
+    out.write(reinterpret_cast<const char*>(palette), sizeof(palette));
+
+    // NETSCAPE2.0 application extension: loop forever
+    const uint8_t loop[19] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E',
+                              '2', '.', '0', 0x03, 0x01, 0x00, 0x00, 0x00};
+    out.write(reinterpret_cast<const char*>(loop), sizeof(loop));
+}
+
+void Recorder::WriteGifFrame(const uint8_t* bits, uint16_t delayCs) {
+    // Graphic control extension carrying the frame delay
+    const uint8_t gce[4] = {0x21, 0xF9, 0x04, 0x04};
+    out.write(reinterpret_cast<const char*>(gce), sizeof(gce));
+    WriteU16(delayCs);
+    out.put(0);
+    out.put(0);
+
+    // Image descriptor covering the whole screen
+    int scaledWidth = frameWidth * gifScale;
+    int scaledHeight = frameHeight * gifScale;
+    out.put(0x2C);
+    WriteU16(0);
+    WriteU16(0);
+    WriteU16((uint16_t)scaledWidth);
+    WriteU16((uint16_t)scaledHeight);
+    out.put(0);
+
+    // Expand 1bpp frame to scaled palette indices
+    uint8_t* dst = indexBuffer.data();
+    for (int y = 0; y < scaledHeight; ++y) {
+        int srcRow = (y / gifScale) * frameWidth;
+        for (int x = 0; x < scaledWidth; ++x) {
+            int i = srcRow + x / gifScale;
+            *dst++ = (bits[i >> 3] & (0x80 >> (i & 7))) ? 1 : 0;
+        }
+    }
+
+    WriteGifImageData(indexBuffer.data(), indexBuffer.size());
+}
+
+void Recorder::WriteGifImageData(const uint8_t* indices, size_t count) {
+    const int minCodeSize = 2;
+    const uint32_t clearCode = 1u << minCodeSize;
+    const uint32_t alphabet = 4;
+
+    out.put((char)minCodeSize);
+
+    uint8_t block[256];
+    int blockSize = 0;
+    uint32_t bitBuffer = 0;
+    int bitCount = 0;
+
+    auto flushBlock = [&]() {
+        if (blockSize > 0) {
+            out.put((char)blockSize);
+            out.write(reinterpret_cast<const char*>(block), blockSize);
+            blockSize = 0;
+        }
+    };
+
+    auto writeCode = [&](uint32_t code, int size) {
+        bitBuffer |= code << bitCount;
+        bitCount += size;
+        while (bitCount >= 8) {
+            block[blockSize++] = (uint8_t)(bitBuffer & 0xFF);
+            bitBuffer >>= 8;
+            bitCount -= 8;
+            if (blockSize == 255) {
+                flushBlock();
+            }
+        }
+    };
+
+    std::fill(lzwTable.begin(), lzwTable.end(), 0);
+    int codeSize = minCodeSize + 1;
+    uint32_t maxCode = clearCode + 1;
+
+    writeCode(clearCode, codeSize);
+
+    int32_t curCode = -1;
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t value = indices[i];
+
+        if (curCode < 0) {
+            curCode = value;
+            continue;
+        }
+
+        uint16_t next = lzwTable[curCode * alphabet + value];
+        if (next) {
+            curCode = next;
+            continue;
+        }
+
+        writeCode((uint32_t)curCode, codeSize);
+        lzwTable[curCode * alphabet + value] = (uint16_t)(++maxCode);
+
+        if (maxCode >= (1u << codeSize)) {
+            ++codeSize;
+        }
+
+        if (maxCode == 4095) {
+            writeCode(clearCode, codeSize);
+            std::fill(lzwTable.begin(), lzwTable.end(), 0);
+            codeSize = minCodeSize + 1;
+            maxCode = clearCode + 1;
+        }
+
+        curCode = value;
+    }
+
+    writeCode((uint32_t)curCode, codeSize);
+    writeCode(clearCode, codeSize);
+    writeCode(clearCode + 1, minCodeSize + 1);
+
+    if (bitCount > 0) {
+        block[blockSize++] = (uint8_t)(bitBuffer & 0xFF);
+    }
+    flushBlock();
+    out.put(0); // Block terminator
+}
+
+void Recorder::WriteRawHeader() {
+    out.write("CH8R", 4);
+    WriteU16((uint16_t)frameWidth);
+    WriteU16((uint16_t)frameHeight);
+}
+
+void Recorder::WriteRawFrame(const uint8_t* bits, uint32_t durationMs) {
+    WriteU32(durationMs);
+    out.write(reinterpret_cast<const char*>(bits), frameBytes);
+}
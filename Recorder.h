@@ -0,0 +1,93 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Largest framebuffer the recorder accepts (room for 128x64 hi-res modes)
+const unsigned int RECORDER_MAX_WIDTH = 128;
+const unsigned int RECORDER_MAX_HEIGHT = 64;
+
+enum class RecordFormat {
+    GIF,    // Animated GIF, identical frames merged into longer delays
+    RAW     // Raw sequence: header followed by (duration, 1bpp frame) records
+};
+
+// Captures finished frames on a background encoder thread.
+// SubmitFrame() never blocks: it packs the framebuffer straight into a
+// preallocated ring slot and publishes it; the encoder reads the slot in place.
+class Recorder {
+public:
+    Recorder();
+    ~Recorder();
+
+    bool Start(const char* filename, int width, int height, int scale = 4);
+    void Stop();
+
+    bool IsRecording() const { return recording; }
+
+    void SubmitFrame(const uint32_t* pixels);
+
+    uint64_t GetFramesWritten() const { return framesWritten; }
+    uint64_t GetFramesDropped() const { return framesDropped; }
+
+private:
+    static const unsigned int SLOT_COUNT = 64;
+    static const unsigned int FRAME_BYTES = RECORDER_MAX_WIDTH * RECORDER_MAX_HEIGHT / 8;
+
+    struct FrameSlot {
+        uint64_t timestampMs;
+        uint8_t bits[FRAME_BYTES];
+    };
+
+    // Ring of frames shared with the encoder thread (single producer, single consumer)
+    std::vector<FrameSlot> slots;
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+
+    std::thread encoderThread;
+    std::mutex wakeMutex;
+    std::condition_variable wakeSignal;
+    std::atomic<bool> recording;
+    std::atomic<bool> stopRequested;
+
+    std::atomic<uint64_t> framesWritten;
+    std::atomic<uint64_t> framesDropped;
+
+    RecordFormat format;
+    std::ofstream out;
+    std::string outputPath;
+    int frameWidth, frameHeight;
+    int frameBytes;
+    int gifScale;
+    uint64_t startTimeMs;
+
+    // Encoder thread state
+    std::vector<uint8_t> pendingFrame;
+    uint64_t pendingStartMs;
+    uint64_t lastEmitCs;
+    bool hasPending;
+    std::vector<uint8_t> indexBuffer;
+    std::vector<uint16_t> lzwTable;
+
+    void EncoderLoop();
+    void ConsumeFrame(const FrameSlot& slot);
+    void EmitPending(uint64_t endMs);
+
+    void WriteGifHeader();
+    void WriteGifFrame(const uint8_t* bits, uint16_t delayCs);
+    void WriteGifImageData(const uint8_t* indices, size_t count);
+    void WriteRawHeader();
+    void WriteRawFrame(const uint8_t* bits, uint32_t durationMs);
+
+    void WriteU16(uint16_t value);
+    void WriteU32(uint32_t value);
+};
+
+#endif // RECORDER_H
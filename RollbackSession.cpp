@@ -0,0 +1,330 @@
+#include "RollbackSession.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#define CLOSE_SOCKET closesocket
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define CLOSE_SOCKET close
+#endif
+
+// Packet: magic, session id, ack, chain frames, chain hash, first input frame,
+// input count, then count 16-bit masks. All little endian.
+const uint32_t PACKET_MAGIC = 0x504E3843;  // "C8NP"
+const size_t PACKET_HEADER = 4 + 8 + 4 + 4 + 8 + 4 + 1;
+const size_t MAX_PACKET_INPUTS = 64;
+
+// Resend unacknowledged input at least this often, even without new frames
+const int RESEND_MS = 5;
+
+static bool SetNonBlocking(intptr_t socket) {
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket((SOCKET)socket, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl((int)socket, F_GETFL, 0);
+    return flags >= 0 && fcntl((int)socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// "port" or "host:port" to an IPv4 address
+static bool ResolveAddress(const std::string& address, const char* defaultHost, sockaddr_in& out) {
+    size_t colon = address.rfind(':');
+    std::string host = colon == std::string::npos ? defaultHost : address.substr(0, colon);
+    int port = std::atoi(address.substr(colon == std::string::npos ? 0 : colon + 1).c_str());
+    if (port <= 0 || port > 65535) {
+        return false;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+        return false;
+    }
+    std::memcpy(&out, result->ai_addr, sizeof(out));
+    freeaddrinfo(result);
+    out.sin_port = htons((uint16_t)port);
+    return true;
+}
+
+static void Put32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out.push_back((uint8_t)(value >> (8 * i)));
+}
+
+static void Put64(std::vector<uint8_t>& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) out.push_back((uint8_t)(value >> (8 * i)));
+}
+
+static uint32_t Get32(const uint8_t* in) {
+    return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+}
+
+static uint64_t Get64(const uint8_t* in) {
+    return (uint64_t)Get32(in) | (uint64_t)Get32(in + 4) << 32;
+}
+
+RollbackSession::RollbackSession(chip8& emulator, unsigned int cyclesPerFrame, unsigned int maxRollback)
+    : emulator(emulator), cyclesPerFrame(cyclesPerFrame), maxRollback(std::max(1u, maxRollback)),
+      socketFd(INVALID), sessionId(0), frame(0), rollbackFrame(UINT32_MAX),
+      peerHashFrames(0), peerHash(0), desynced(false), desyncFrame(0),
+      peerAck(0), sendPending(false), warnedSession(false), packetLoss(0.0),
+      rollbackCount(0), resimulatedFrames(0), resimulationMs(0.0) {
+    // Frames from the oldest unconfirmed one to the newest, plus slack
+    snapshots.resize(this->maxRollback + 2);
+}
+
+RollbackSession::~RollbackSession() {
+    Close();
+}
+
+bool RollbackSession::Open(const std::string& localAddress, const std::string& peer, uint64_t id) {
+    Close();
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::cerr << "Netplay: WSAStartup failed" << std::endl;
+        return false;
+    }
+#endif
+
+    sockaddr_in local{};
+    sockaddr_in remote{};
+    if (!ResolveAddress(localAddress, "127.0.0.1", local)) {
+        std::cerr << "Netplay: bad local address " << localAddress << std::endl;
+        return false;
+    }
+    if (peer.find(':') == std::string::npos || !ResolveAddress(peer, "127.0.0.1", remote)) {
+        std::cerr << "Netplay: bad peer address " << peer << " (expected host:port)" << std::endl;
+        return false;
+    }
+
+    Socket fd = (Socket)socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == INVALID || bind(fd, (sockaddr*)&local, sizeof(local)) != 0 || !SetNonBlocking(fd)) {
+        std::cerr << "Netplay: cannot bind " << localAddress << std::endl;
+        if (fd != INVALID) CLOSE_SOCKET(fd);
+        return false;
+    }
+
+    socketFd = fd;
+    peerAddress.assign((const uint8_t*)&remote, (const uint8_t*)&remote + sizeof(remote));
+    sessionId = id;
+    lastSend = lastReceive = std::chrono::steady_clock::now();
+    sendPending = true;
+    std::cerr << "Netplay: " << localAddress << " <-> " << peer << std::endl;
+    return true;
+}
+
+void RollbackSession::Close() {
+    if (socketFd != INVALID) {
+        CLOSE_SOCKET(socketFd);
+        socketFd = INVALID;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+}
+
+double RollbackSession::GetSilenceMs() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - lastReceive).count();
+}
+
+uint16_t RollbackSession::RemoteInputFor(uint32_t f) const {
+    if (f < remoteInputs.size()) {
+        return remoteInputs[f];
+    }
+    return remoteInputs.empty() ? 0 : remoteInputs.back();
+}
+
+void RollbackSession::RunFrame(uint32_t f) {
+    snapshots[f % snapshots.size()] = emulator.clone();
+
+    uint16_t remote = RemoteInputFor(f);
+    if (usedRemote.size() <= f) {
+        usedRemote.resize(f + 1);
+    }
+    usedRemote[f] = remote;
+
+    uint16_t keys = localInputs[f] | remote;
+    for (int key = 0; key < 16; ++key) {
+        emulator.keypad[key] = (keys >> key) & 1;
+    }
+    emulator.emulateFrame(cyclesPerFrame);
+}
+
+bool RollbackSession::AdvanceFrame(uint16_t localKeys) {
+    if (frame >= remoteInputs.size() + maxRollback) {
+        return false;
+    }
+
+    localInputs.push_back(localKeys);
+    RunFrame(frame);
+    ++frame;
+    sendPending = true;
+
+    UpdateChain();
+    return true;
+}
+
+void RollbackSession::RollBack() {
+    if (rollbackFrame >= frame) {
+        rollbackFrame = UINT32_MAX;
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    emulator = snapshots[rollbackFrame % snapshots.size()].clone();
+    for (uint32_t f = rollbackFrame; f < frame; ++f) {
+        RunFrame(f);
+    }
+
+    ++rollbackCount;
+    resimulatedFrames += frame - rollbackFrame;
+    resimulationMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    rollbackFrame = UINT32_MAX;
+}
+
+// Hash the state after each frame that just became final
+void RollbackSession::UpdateChain() {
+    uint32_t confirmed = GetConfirmedFrame();
+    while (chain.size() < confirmed) {
+        uint32_t f = (uint32_t)chain.size();
+        const chip8& after = (f + 1 == frame) ? emulator : snapshots[(f + 1) % snapshots.size()];
+        uint64_t previous = chain.empty() ? 14695981039346656037ull : chain.back();
+        chain.push_back((previous ^ after.hashState()) * 1099511628211ull);
+    }
+    CheckPeerHash();
+}
+
+void RollbackSession::CheckPeerHash() {
+    if (desynced || peerHashFrames == 0 || peerHashFrames > chain.size()) {
+        return;
+    }
+    if (chain[peerHashFrames - 1] != peerHash) {
+        desynced = true;
+        desyncFrame = peerHashFrames - 1;
+        std::cerr << "Netplay: desync detected by frame " << desyncFrame << std::endl;
+    }
+}
+
+void RollbackSession::Poll() {
+    if (socketFd == INVALID) {
+        return;
+    }
+
+    Receive();
+    RollBack();
+    UpdateChain();
+
+    auto now = std::chrono::steady_clock::now();
+    if (sendPending || now - lastSend >= std::chrono::milliseconds(RESEND_MS)) {
+        Send();
+        lastSend = now;
+        sendPending = false;
+    }
+}
+
+void RollbackSession::Receive() {
+    uint8_t buffer[1024];
+    for (;;) {
+        sockaddr_in from{};
+        socklen_t fromSize = sizeof(from);
+        int received = (int)recvfrom(socketFd, (char*)buffer, sizeof(buffer), 0, (sockaddr*)&from, &fromSize);
+        if (received < 0) {
+            // Would block (or an ICMP error from a peer not yet listening)
+            return;
+        }
+
+        const sockaddr_in* peer = (const sockaddr_in*)peerAddress.data();
+        if (from.sin_addr.s_addr != peer->sin_addr.s_addr || from.sin_port != peer->sin_port) {
+            continue;
+        }
+        HandlePacket(buffer, (size_t)received);
+    }
+}
+
+void RollbackSession::HandlePacket(const uint8_t* data, size_t size) {
+    if (size < PACKET_HEADER || Get32(data) != PACKET_MAGIC) {
+        return;
+    }
+    if (Get64(data + 4) != sessionId) {
+        if (!warnedSession) {
+            std::cerr << "Netplay: peer runs a different ROM or settings, ignoring it" << std::endl;
+            warnedSession = true;
+        }
+        return;
+    }
+
+    uint32_t ack = Get32(data + 12);
+    uint32_t hashFrames = Get32(data + 16);
+    uint64_t hash = Get64(data + 20);
+    uint32_t first = Get32(data + 28);
+    size_t count = data[32];
+    if (size < PACKET_HEADER + count * 2) {
+        return;
+    }
+
+    lastReceive = std::chrono::steady_clock::now();
+    peerAck = std::max(peerAck, ack);
+    if (hashFrames > peerHashFrames) {
+        peerHashFrames = hashFrames;
+        peerHash = hash;
+    }
+
+    // Take inputs that extend what we have; later ones come again after our ack
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t f = first + (uint32_t)i;
+        if (f != remoteInputs.size()) {
+            continue;
+        }
+        uint16_t keys = (uint16_t)(data[PACKET_HEADER + i * 2] | data[PACKET_HEADER + i * 2 + 1] << 8);
+        remoteInputs.push_back(keys);
+
+        if (f < frame && usedRemote[f] != keys) {
+            rollbackFrame = std::min(rollbackFrame, f);
+        }
+    }
+}
+
+void RollbackSession::Send() {
+    if (packetLoss > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(lossGen) < packetLoss) {
+        return;
+    }
+
+    uint32_t first = std::min(peerAck, (uint32_t)localInputs.size());
+    size_t count = std::min(localInputs.size() - first, MAX_PACKET_INPUTS);
+
+    std::vector<uint8_t> packet;
+    packet.reserve(PACKET_HEADER + count * 2);
+    Put32(packet, PACKET_MAGIC);
+    Put64(packet, sessionId);
+    Put32(packet, (uint32_t)remoteInputs.size());
+    Put32(packet, (uint32_t)chain.size());
+    Put64(packet, chain.empty() ? 0 : chain.back());
+    Put32(packet, first);
+    packet.push_back((uint8_t)count);
+    for (size_t i = 0; i < count; ++i) {
+        packet.push_back((uint8_t)localInputs[first + i]);
+        packet.push_back((uint8_t)(localInputs[first + i] >> 8));
+    }
+
+    sendto(socketFd, (const char*)packet.data(), (int)packet.size(), 0,
+           (const sockaddr*)peerAddress.data(), (socklen_t)peerAddress.size());
+}
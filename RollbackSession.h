@@ -0,0 +1,115 @@
+#ifndef ROLLBACKSESSION_H
+#define ROLLBACKSESSION_H
+
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include "chip8.h"
+
+// Two-player rollback netplay over UDP for games where both players share the
+// keypad (the keys each frame are the OR of both players' masks). Local input
+// takes effect at once; the peer's input is predicted as its last known mask.
+// When the real mask arrives and differs, the emulator is restored from the
+// snapshot taken at the start of that frame and the frames since are run
+// again. Snapshots are chip8 clones, so keeping one per frame costs only the
+// pages the game writes.
+//
+// Each side hashes the state after every frame both inputs are known for
+// (chip8::hashState) into a running chain and sends the latest value; a
+// mismatch means the two emulators have diverged.
+//
+// Packets carry every input the peer has not acknowledged, so a lost packet
+// is covered by the next one. Both sides must start from the same state with
+// the same session id (e.g. a hash of ROM, seed and cycles per frame).
+class RollbackSession {
+public:
+    RollbackSession(chip8& emulator, unsigned int cyclesPerFrame, unsigned int maxRollback = 8);
+    ~RollbackSession();
+
+    RollbackSession(const RollbackSession&) = delete;
+    RollbackSession& operator=(const RollbackSession&) = delete;
+
+    // localAddress: "port" (loopback) or "host:port"; peerAddress: "host:port"
+    bool Open(const std::string& localAddress, const std::string& peerAddress, uint64_t sessionId);
+    void Close();
+
+    // Receive packets, roll back for late peer input and send our inputs
+    void Poll();
+
+    // Run the next frame with the local keys (bit k = key k down). Returns
+    // false without running it when already maxRollback frames ahead of the
+    // peer's input; Poll() and try again.
+    bool AdvanceFrame(uint16_t localKeys);
+
+    // Frames run so far, and how many of them have both players' input
+    uint32_t GetFrame() const { return frame; }
+    uint32_t GetConfirmedFrame() const { return std::min(frame, (uint32_t)remoteInputs.size()); }
+
+    // Both players' input is known for the first frames, and the peer has ours
+    bool IsSettled(uint32_t frames) const { return remoteInputs.size() >= frames && peerAck >= frames; }
+
+    bool IsDesynced() const { return desynced; }
+    uint32_t GetDesyncFrame() const { return desyncFrame; }
+
+    // Milliseconds since the last packet from the peer (or since Open)
+    double GetSilenceMs() const;
+
+    // Drop this fraction of outgoing packets, for testing over localhost
+    void SetPacketLoss(double fraction) { packetLoss = fraction; }
+
+    uint64_t GetRollbackCount() const { return rollbackCount; }
+    uint64_t GetResimulatedFrames() const { return resimulatedFrames; }
+    double GetResimulationMs() const { return resimulationMs; }
+
+private:
+    typedef intptr_t Socket;
+    static const Socket INVALID = -1;
+
+    chip8& emulator;
+    unsigned int cyclesPerFrame;
+    unsigned int maxRollback;
+
+    Socket socketFd;
+    std::vector<uint8_t> peerAddress;   // sockaddr bytes
+    uint64_t sessionId;
+
+    uint32_t frame;                     // Next frame to run
+    std::vector<uint16_t> localInputs;  // One per frame run
+    std::vector<uint16_t> remoteInputs; // Known peer input, frames 0..size-1
+    std::vector<uint16_t> usedRemote;   // Peer input each frame was run with
+    std::vector<chip8> snapshots;       // State at the start of frame f, at f % size
+    uint32_t rollbackFrame;             // Earliest mispredicted frame, or UINT32_MAX
+
+    std::vector<uint64_t> chain;        // Running state hash after each confirmed frame
+    uint32_t peerHashFrames;            // Peer's chain covers this many frames
+    uint64_t peerHash;
+    bool desynced;
+    uint32_t desyncFrame;
+
+    uint32_t peerAck;                   // Peer holds our inputs for frames below this
+    bool sendPending;
+    std::chrono::steady_clock::time_point lastSend;
+    std::chrono::steady_clock::time_point lastReceive;
+    bool warnedSession;
+
+    double packetLoss;
+    std::default_random_engine lossGen;
+
+    uint64_t rollbackCount;
+    uint64_t resimulatedFrames;
+    double resimulationMs;
+
+    uint16_t RemoteInputFor(uint32_t f) const;
+    void RunFrame(uint32_t f);
+    void RollBack();
+    void UpdateChain();
+    void CheckPeerHash();
+    void Receive();
+    void HandlePacket(const uint8_t* data, size_t size);
+    void Send();
+};
+
+#endif // ROLLBACKSESSION_H
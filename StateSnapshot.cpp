@@ -0,0 +1,66 @@
+#include "StateSnapshot.h"
+#include <cstring>
+
+void Chip8Snapshot::Capture(const chip8& emulator, bool isPaused) {
+    static_assert(VIDEO_WIDTH <= SNAPSHOT_MAX_WIDTH && VIDEO_HEIGHT <= SNAPSHOT_MAX_HEIGHT,
+                  "Chip8Snapshot is too small for the display");
+
+    std::memcpy(registers_V, emulator.registers_V, sizeof(registers_V));
+    emulator.memory.Read(0, memory, sizeof(memory));
+    // Only the active display; the rest of the buffer is left as it was
+    display_width = VIDEO_WIDTH;
+    display_height = VIDEO_HEIGHT;
+    std::memcpy(graphics, emulator.graphics.data(), VIDEO_WIDTH * VIDEO_HEIGHT * sizeof(uint32_t));
+    std::memcpy(keypad, emulator.keypad, sizeof(keypad));
+    std::memcpy(stack, emulator.stack, sizeof(stack));
+
+    delay_timer = emulator.delay_timer;
+    sound_timer = emulator.sound_timer;
+    stack_pointer = emulator.stack_pointer;
+    index_register = emulator.index_register;
+    program_counter = emulator.program_counter;
+    opcode = emulator.opcode;
+    cycle_count = emulator.cycle_count;
+    frame_count = emulator.frame_count;
+
+    paused = isPaused;
+    break_reason = emulator.break_reason;
+    break_address = emulator.break_address;
+    if (emulator.breakpoints) {
+        std::memcpy(breakpointBits, emulator.breakpoints->GetBreakpointBits(), sizeof(breakpointBits));
+    } else {
+        std::memset(breakpointBits, 0, sizeof(breakpointBits));
+    }
+
+    has_access_counts = emulator.access_counts != nullptr;
+    if (has_access_counts) {
+        access_counts = *emulator.access_counts;
+    }
+
+    has_pixel_origins = emulator.pixel_origins != nullptr;
+    if (has_pixel_origins) {
+        std::memcpy(pixel_origins, emulator.pixel_origins, VIDEO_WIDTH * VIDEO_HEIGHT * sizeof(PixelOrigin));
+    }
+}
+
+SnapshotBuffer::SnapshotBuffer()
+    : slots{}, middle(1), writeIndex(0), readIndex(2), sequence(0), hasSnapshot(false) {
+}
+
+void SnapshotBuffer::Publish(const chip8& emulator, bool paused) {
+    Chip8Snapshot& slot = slots[writeIndex];
+    slot.Capture(emulator, paused);
+    slot.sequence = ++sequence;
+
+    // Release makes the copy visible to whoever picks this slot up
+    writeIndex = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel) & 3;
+}
+
+const Chip8Snapshot* SnapshotBuffer::Acquire() {
+    if (middle.load(std::memory_order_relaxed) & FRESH) {
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & 3;
+        hasSnapshot = true;
+    }
+
+    return hasSnapshot ? &slots[readIndex] : nullptr;
+}
@@ -0,0 +1,81 @@
+#ifndef STATESNAPSHOT_H
+#define STATESNAPSHOT_H
+
+#include <cstdint>
+#include <atomic>
+#include "chip8.h"
+#include "Breakpoints.h"
+
+// Largest display a snapshot holds (128x64 hi-res); each snapshot records
+// the size the emulator was using
+const unsigned int SNAPSHOT_MAX_WIDTH = 128;
+const unsigned int SNAPSHOT_MAX_HEIGHT = 64;
+
+// Copy of everything the debugger shows, taken between two emulated cycles
+struct Chip8Snapshot {
+    uint8_t registers_V[16];
+    uint8_t memory[4096];
+    uint32_t graphics[SNAPSHOT_MAX_WIDTH * SNAPSHOT_MAX_HEIGHT];   // display_width pixels per row
+    uint16_t display_width;
+    uint16_t display_height;
+    uint8_t keypad[16];
+
+    uint8_t delay_timer;
+    uint8_t sound_timer;
+
+    uint16_t stack_pointer;
+    uint16_t stack[16];
+    uint16_t index_register;
+    uint16_t program_counter;
+    uint16_t opcode;
+
+    uint64_t cycle_count;
+    uint64_t frame_count;
+    uint64_t sequence;      // Increases with every publish
+
+    // Run control
+    bool paused;
+    BreakReason break_reason;
+    uint16_t break_address;
+    uint64_t breakpointBits[Breakpoints::WORDS];
+
+    // Memory access profile, when the emulator collects one
+    bool has_access_counts;
+    MemoryAccessCounts access_counts;
+
+    // Which instruction last drew each pixel, when tracked
+    bool has_pixel_origins;
+    PixelOrigin pixel_origins[SNAPSHOT_MAX_WIDTH * SNAPSHOT_MAX_HEIGHT];
+
+    void Capture(const chip8& emulator, bool isPaused);
+};
+
+// Single producer, single consumer triple buffer. The emulator publishes into
+// a slot the reader cannot see, then swaps it with the shared middle slot; the
+// reader swaps the middle slot for its own. Neither side waits, and a slot is
+// never written while it is being read, so snapshots can't tear. The two sides
+// may run on separate threads; the emulator and debugger both use it from the
+// main loop.
+class SnapshotBuffer {
+public:
+    SnapshotBuffer();
+
+    // Producer
+    void Publish(const chip8& emulator, bool paused = false);
+
+    // Consumer: latest complete snapshot, or nullptr before the first
+    // publish. The pointer stays valid until the next call.
+    const Chip8Snapshot* Acquire();
+
+private:
+    static const uint32_t FRESH = 4;    // Middle slot holds an unread snapshot
+
+    Chip8Snapshot slots[3];
+    std::atomic<uint32_t> middle;
+    uint32_t writeIndex;                // Producer only
+    uint32_t readIndex;                 // Consumer only
+    uint64_t sequence;
+    bool hasSnapshot;
+};
+
+#endif // STATESNAPSHOT_H
@@ -0,0 +1,251 @@
+// Input search: looks for a keypad sequence that maximises a score read from
+// emulator state (e.g. a score byte in memory) or reaches a goal condition.
+// Runs a beam search: each surviving state is cloned once per candidate key
+// mask and run headless for a few frames on a work-stealing pool. States seen
+// before (by chip8::hashState()) are dropped, and the best input found is
+// written in the chip8_headless --input format.
+#include "chip8.h"
+#include "Breakpoints.h"
+#include "WorkStealingPool.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+struct SearchNode {
+    chip8 state;
+    std::vector<uint16_t> inputs;   // Key mask held for each step so far
+    int score;
+    uint64_t hash;
+    bool goal;
+};
+
+static void SetKeys(chip8& chip8, uint16_t mask) {
+    for (int key = 0; key < 16; ++key) {
+        chip8.keypad[key] = (mask >> key) & 1;
+    }
+}
+
+// Comma separated hex masks, e.g. "0,10,20"
+static bool ParseKeys(const std::string& text, std::vector<uint16_t>& keys) {
+    std::istringstream items(text);
+    std::string item;
+    try {
+        while (std::getline(items, item, ',')) {
+            keys.push_back((uint16_t)std::stoul(item, nullptr, 16));
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    return !keys.empty();
+}
+
+// One "<frame> <hex keymask>" line per change, as chip8_headless --input reads
+static bool WriteMovie(const char* filename, const std::vector<uint16_t>& inputs, uint64_t firstFrame, unsigned int hold) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to write movie file: " << filename << std::endl;
+        return false;
+    }
+
+    file << "# chip8_tas: " << inputs.size() << " steps of " << hold << " frames\n";
+    for (size_t step = 0; step < inputs.size(); ++step) {
+        if (step == 0 || inputs[step] != inputs[step - 1]) {
+            char mask[8];
+            std::snprintf(mask, sizeof(mask), "%04x", inputs[step]);
+            file << firstFrame + step * hold << " " << mask << "\n";
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4 || std::string(argv[2]) != "--score")
+    {
+        std::cerr << "Usage: " << argv[0] << " <ROM> --score <expr> [--goal <cond>] [--steps <n>] [--hold <frames>] [--beam <n>] [--threads <n>] [--keys <masks>] [--cycles-per-frame <n>] [--seed <n>] [--skip <frames>] [--out <file>]\n";
+        std::cerr << "  --score: Value to maximise, e.g. \"[0x3F0] * 256 + [0x3F1]\" (breakpoint condition operands plus + - *)\n";
+        std::cerr << "  --goal: Optional - stop at the first step where this condition holds, e.g. \"V5 >= 10\"\n";
+        std::cerr << "  --steps: Optional - input changes to search (default 60)\n";
+        std::cerr << "  --hold: Optional - frames each input is held (default 4)\n";
+        std::cerr << "  --beam: Optional - states kept after each step (default 64)\n";
+        std::cerr << "  --threads: Optional - worker threads (default: all hardware threads)\n";
+        std::cerr << "  --keys: Optional - comma separated hex key masks to try (default: none and each single key)\n";
+        std::cerr << "  --cycles-per-frame: Optional - instructions per frame (default 10)\n";
+        std::cerr << "  --seed: Optional - random number seed for CXNN (default 0)\n";
+        std::cerr << "  --skip: Optional - frames to run with no keys before searching (default 0)\n";
+        std::cerr << "  --out: Optional - movie file for chip8_headless --input (default movie.txt)\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    char const* romFilename = argv[1];
+    std::string scoreText = argv[3];
+    std::string goalText;
+    unsigned int steps = 60;
+    unsigned int hold = 4;
+    size_t beamWidth = 64;
+    unsigned int threadCount = 0;
+    std::vector<uint16_t> keys;
+    unsigned int cyclesPerFrame = 10;
+    unsigned int seed = 0;
+    uint64_t skip = 0;
+    char const* movieFilename = "movie.txt";
+
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--goal" && i + 1 < argc) {
+            goalText = argv[++i];
+        } else if (arg == "--steps" && i + 1 < argc) {
+            steps = (unsigned int)std::stoul(argv[++i]);
+        } else if (arg == "--hold" && i + 1 < argc) {
+            hold = std::max(1u, (unsigned int)std::stoul(argv[++i]));
+        } else if (arg == "--beam" && i + 1 < argc) {
+            beamWidth = std::max<size_t>(1, std::stoul(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threadCount = (unsigned int)std::stoul(argv[++i]);
+        } else if (arg == "--keys" && i + 1 < argc) {
+            if (!ParseKeys(argv[++i], keys)) {
+                std::cerr << "Bad key mask list: " << argv[i] << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+        } else if (arg == "--cycles-per-frame" && i + 1 < argc) {
+            cyclesPerFrame = (unsigned int)std::stoul(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = (unsigned int)std::stoul(argv[++i], nullptr, 0);
+        } else if (arg == "--skip" && i + 1 < argc) {
+            skip = std::stoull(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            movieFilename = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    std::string error;
+    ValueExpression score = Breakpoints::CompileExpression(scoreText, &error);
+    if (!score) {
+        std::cerr << "Bad score expression: " << error << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    BreakCondition goal;
+    if (!goalText.empty()) {
+        goal = Breakpoints::CompileCondition(goalText, &error);
+        if (!goal) {
+            std::cerr << "Bad goal condition: " << error << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    if (keys.empty()) {
+        keys.push_back(0);
+        for (int key = 0; key < 16; ++key) {
+            keys.push_back((uint16_t)(1 << key));
+        }
+    }
+
+    SearchNode root;
+    if (!root.state.LoadROM(romFilename)) {
+        std::exit(EXIT_FAILURE);
+    }
+    root.state.randGen.seed(seed);
+    while (root.state.frame_count < skip) {
+        root.state.emulateFrame(cyclesPerFrame);
+    }
+    root.score = score(root.state);
+    root.hash = root.state.hashState();
+    root.goal = goal && goal(root.state);
+
+    std::vector<SearchNode> beam;
+    beam.push_back(root);
+    SearchNode best = root;
+
+    // Every state ever kept; reaching one again later can only be slower
+    std::unordered_set<uint64_t> seen;
+    seen.insert(root.hash);
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t expanded = 0;
+    uint64_t duplicates = 0;
+    unsigned int threadsUsed;
+    {
+        WorkStealingPool pool(threadCount);
+        threadsUsed = pool.GetThreadCount();
+
+        for (unsigned int step = 0; step < steps && !best.goal && !beam.empty(); ++step) {
+            // Each task expands one parent into its own list of children,
+            // built straight from clone() rather than default-constructed first
+            std::vector<std::vector<SearchNode>> children(beam.size());
+            for (size_t parent = 0; parent < beam.size(); ++parent) {
+                pool.Submit([&, parent] {
+                    std::vector<SearchNode>& expansion = children[parent];
+                    expansion.reserve(keys.size());
+                    for (size_t k = 0; k < keys.size(); ++k) {
+                        expansion.push_back({beam[parent].state.clone(), beam[parent].inputs, 0, 0, false});
+                        SearchNode& child = expansion.back();
+                        SetKeys(child.state, keys[k]);
+                        for (unsigned int frame = 0; frame < hold; ++frame) {
+                            child.state.emulateFrame(cyclesPerFrame);
+                        }
+                        child.inputs.push_back(keys[k]);
+                        child.score = score(child.state);
+                        child.hash = child.state.hashState();
+                        child.goal = goal && goal(child.state);
+                    }
+                });
+            }
+            pool.Wait();
+
+            auto node = [&](size_t i) -> SearchNode& { return children[i / keys.size()][i % keys.size()]; };
+            size_t childCount = beam.size() * keys.size();
+            expanded += childCount;
+
+            // Best first; ties keep expansion order so runs are repeatable
+            std::vector<size_t> order(childCount);
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                if (node(a).goal != node(b).goal) return node(a).goal;
+                return node(a).score > node(b).score;
+            });
+
+            std::vector<SearchNode> next;
+            for (size_t i : order) {
+                if (next.size() == beamWidth) break;
+                if (!seen.insert(node(i).hash).second) {
+                    ++duplicates;
+                    continue;
+                }
+                next.push_back(std::move(node(i)));
+            }
+            beam = std::move(next);
+
+            if (!beam.empty() && (beam[0].goal || beam[0].score > best.score)) {
+                best = beam[0];
+            }
+            std::cerr << "step " << step + 1 << ": " << beam.size() << " states, best score " << best.score
+                      << (best.goal ? " (goal reached)" : "") << std::endl;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!WriteMovie(movieFilename, best.inputs, skip, hold)) {
+        std::exit(EXIT_FAILURE);
+    }
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)best.state.hashGraphics());
+    std::cout << "score " << best.score << (best.goal ? ", goal reached" : "") << " after "
+              << best.state.frame_count << " frames, framebuffer hash " << hash << std::endl;
+    std::cout << "replay: chip8_headless " << romFilename << " " << best.state.frame_count << " --input "
+              << movieFilename << " --cycles-per-frame " << cyclesPerFrame << " --seed " << seed << std::endl;
+    std::cerr << expanded << " states expanded (" << duplicates << " duplicates pruned) on " << threadsUsed
+              << " threads in " << seconds << " s" << std::endl;
+
+    return 0;
+}
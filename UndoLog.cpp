@@ -0,0 +1,249 @@
+#include "UndoLog.h"
+#include "chip8.h"
+#include <cstring>
+
+UndoLog::UndoLog(size_t capacityBytes) : head(0), tail(0), count(0), record{} {
+    // Round up to a power of two so positions wrap with a mask
+    size_t capacity = 1024;
+    while (capacity < capacityBytes) capacity <<= 1;
+    buffer.resize(capacity);
+    mask = capacity - 1;
+}
+
+void UndoLog::WriteBytes(uint64_t pos, const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        buffer[(pos + i) & mask] = data[i];
+    }
+}
+
+void UndoLog::ReadBytes(uint64_t pos, uint8_t* data, size_t size) const {
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = buffer[(pos + i) & mask];
+    }
+}
+
+uint16_t UndoLog::ReadLength(uint64_t pos) const {
+    uint8_t bytes[2];
+    ReadBytes(pos, bytes, 2);
+    return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+static void Put8(uint8_t*& out, uint8_t value) {
+    *out++ = value;
+}
+
+static void Put16(uint8_t*& out, uint16_t value) {
+    *out++ = (uint8_t)value;
+    *out++ = (uint8_t)(value >> 8);
+}
+
+static uint8_t Get8(const uint8_t*& in) {
+    return *in++;
+}
+
+static uint16_t Get16(const uint8_t*& in) {
+    uint16_t value = (uint16_t)(in[0] | (in[1] << 8));
+    in += 2;
+    return value;
+}
+
+void UndoLog::Record(const chip8& emulator) {
+    uint16_t pc = emulator.program_counter;
+    uint16_t opcode = (emulator.memory[pc & 0xFFF] << 8) | emulator.memory[(pc + 1) & 0xFFF];
+    uint8_t x = (opcode & 0x0F00) >> 8;
+    uint8_t y = (opcode & 0x00F0) >> 4;
+
+    // Work out what this instruction overwrites
+    uint16_t registerMask = 0;
+    uint16_t memoryStart = 0;
+    uint8_t memoryCount = 0;
+    bool saveStack = false;
+    uint32_t rowMask = 0;
+
+    switch (opcode & 0xF000) {
+        case 0x0000:
+            // Decoded like the interpreter does: only the low byte matters
+            if ((opcode & 0x00FF) == 0x00E0) rowMask = 0xFFFFFFFF;
+            break;
+        case 0x2000:
+            saveStack = emulator.stack_pointer < 16;
+            break;
+        case 0x6000:
+        case 0x7000:
+        case 0xC000:
+            registerMask = 1 << x;
+            break;
+        case 0x8000:
+            registerMask = (1 << x) | (1 << 0xF);
+            break;
+        case 0xD000: {
+            registerMask = 1 << 0xF;
+            uint8_t top = emulator.registers_V[y];
+            for (int row = 0; row < (opcode & 0x000F); ++row) {
+                rowMask |= 1u << ((top + row) % VIDEO_HEIGHT);
+            }
+            break;
+        }
+        case 0xF000:
+            switch (opcode & 0x00FF) {
+                case 0x07:
+                case 0x0A:
+                    registerMask = 1 << x;
+                    break;
+                case 0x33:
+                    memoryStart = emulator.index_register;
+                    memoryCount = 3;
+                    break;
+                case 0x55:
+                    memoryStart = emulator.index_register;
+                    memoryCount = x + 1;
+                    break;
+                case 0x65:
+                    registerMask = (uint16_t)((2u << x) - 1);
+                    break;
+            }
+            break;
+    }
+
+    // Wrap at 4 KB like the core's writes; Read() and Write() wrap the rest
+    memoryStart &= 0xFFF;
+
+    uint8_t flags = (registerMask ? HAS_REGISTERS : 0) | (memoryCount ? HAS_MEMORY : 0) |
+                    (saveStack ? HAS_STACK : 0) | (rowMask ? HAS_ROWS : 0);
+
+    // Fixed part: everything any instruction (or the timer tick) may change
+    uint8_t* out = record;
+    Put8(out, flags);
+    Put16(out, pc);
+    Put16(out, emulator.opcode);
+    Put16(out, emulator.index_register);
+    Put16(out, emulator.stack_pointer);
+    Put8(out, emulator.delay_timer);
+    Put8(out, emulator.sound_timer);
+
+    if (flags & HAS_REGISTERS) {
+        Put16(out, registerMask);
+        for (int i = 0; i < 16; ++i) {
+            if (registerMask & (1 << i)) Put8(out, emulator.registers_V[i]);
+        }
+    }
+
+    if (flags & HAS_MEMORY) {
+        Put16(out, memoryStart);
+        Put8(out, memoryCount);
+        emulator.memory.Read(memoryStart, out, memoryCount);
+        out += memoryCount;
+    }
+
+    if (flags & HAS_STACK) {
+        Put16(out, emulator.stack[emulator.stack_pointer]);
+    }
+
+    if (flags & HAS_ROWS) {
+        Put16(out, (uint16_t)rowMask);
+        Put16(out, (uint16_t)(rowMask >> 16));
+        for (unsigned row = 0; row < VIDEO_HEIGHT; ++row) {
+            if (!(rowMask & (1u << row))) continue;
+
+            // One bit per pixel
+            uint64_t bits = 0;
+            const uint32_t* pixels = emulator.graphics + row * VIDEO_WIDTH;
+            for (unsigned col = 0; col < VIDEO_WIDTH; ++col) {
+                if (pixels[col]) bits |= 1ULL << col;
+            }
+            std::memcpy(out, &bits, sizeof(bits));
+            out += sizeof(bits);
+        }
+    }
+
+    // Framed by its length on both ends so the ring can be walked either way
+    uint16_t length = (uint16_t)(out - record);
+    uint64_t needed = (uint64_t)length + 4;
+
+    while (buffer.size() - (head - tail) < needed && count > 0) {
+        tail += ReadLength(tail) + 4;
+        --count;
+    }
+
+    uint8_t lengthBytes[2] = {(uint8_t)length, (uint8_t)(length >> 8)};
+    WriteBytes(head, lengthBytes, 2);
+    WriteBytes(head + 2, record, length);
+    WriteBytes(head + 2 + length, lengthBytes, 2);
+    head += needed;
+    ++count;
+}
+
+void UndoLog::DropLast() {
+    if (count == 0) return;
+    head -= ReadLength(head - 2) + 4;
+    --count;
+}
+
+bool UndoLog::StepBack(chip8& emulator) {
+    if (count == 0) {
+        return false;
+    }
+
+    uint16_t length = ReadLength(head - 2);
+    uint64_t start = head - 2 - length;
+    ReadBytes(start, record, length);
+    head = start - 2;
+    --count;
+
+    const uint8_t* in = record;
+    uint8_t flags = Get8(in);
+    emulator.program_counter = Get16(in);
+    emulator.opcode = Get16(in);
+    emulator.index_register = Get16(in);
+    emulator.stack_pointer = Get16(in);
+    emulator.delay_timer = Get8(in);
+    emulator.sound_timer = Get8(in);
+
+    if (flags & HAS_REGISTERS) {
+        uint16_t registerMask = Get16(in);
+        for (int i = 0; i < 16; ++i) {
+            if (registerMask & (1 << i)) emulator.registers_V[i] = Get8(in);
+        }
+    }
+
+    if (flags & HAS_MEMORY) {
+        uint16_t memoryStart = Get16(in);
+        uint8_t memoryCount = Get8(in);
+        emulator.memory.Write(memoryStart, in, memoryCount);
+        in += memoryCount;
+    }
+
+    if (flags & HAS_STACK) {
+        emulator.stack[emulator.stack_pointer] = Get16(in);
+    }
+
+    if (flags & HAS_ROWS) {
+        uint32_t rowMask = Get16(in);
+        rowMask |= (uint32_t)Get16(in) << 16;
+        for (unsigned row = 0; row < VIDEO_HEIGHT; ++row) {
+            if (!(rowMask & (1u << row))) continue;
+
+            uint64_t bits;
+            std::memcpy(&bits, in, sizeof(bits));
+            in += sizeof(bits);
+
+            uint32_t* pixels = emulator.graphics.Writable() + row * VIDEO_WIDTH;
+            for (unsigned col = 0; col < VIDEO_WIDTH; ++col) {
+                pixels[col] = ((bits >> col) & 1) ? 0xFFFFFFFF : 0;
+            }
+        }
+    }
+
+    if (emulator.cycle_count > 0) {
+        --emulator.cycle_count;
+    }
+
+    // Stepping forward again from here must not stop at the same breakpoint
+    emulator.break_reason = BreakReason::None;
+    emulator.resume_from_break = true;
+    return true;
+}
+
+void UndoLog::Clear() {
+    head = tail = count = 0;
+}
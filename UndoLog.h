@@ -0,0 +1,54 @@
+#ifndef UNDOLOG_H
+#define UNDOLOG_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class chip8;
+
+// Instruction-level reverse execution. Before each cycle, Record() decodes
+// the instruction at PC and saves only the state it is about to overwrite:
+// PC, I, SP, the timers, the registers it writes, up to 16 memory bytes, a
+// stack slot and the framebuffer rows a DXYN touches (all 32 for CLS).
+// Records are variable length and live in a fixed byte ring; the oldest are
+// dropped when it fills. The random number generator is not rewound.
+class UndoLog {
+public:
+    explicit UndoLog(size_t capacityBytes = 16u << 20);
+
+    // Call right before chip8::emulateCycle()
+    void Record(const chip8& emulator);
+    // Forget the last record, for a cycle that stopped at a breakpoint
+    void DropLast();
+    // Restore the state from before the last recorded instruction
+    bool StepBack(chip8& emulator);
+    void Clear();
+
+    uint64_t GetDepth() const { return count; }
+    size_t GetBytesUsed() const { return (size_t)(head - tail); }
+
+private:
+    // Which optional parts follow the fixed header
+    static const uint8_t HAS_REGISTERS = 1;
+    static const uint8_t HAS_MEMORY = 2;
+    static const uint8_t HAS_STACK = 4;
+    static const uint8_t HAS_ROWS = 8;
+
+    // Largest record: header, 16 registers, 16 memory bytes, a stack slot and 32 rows
+    static const size_t MAX_RECORD = 512;
+
+    std::vector<uint8_t> buffer;
+    uint64_t mask;
+    uint64_t head;      // Monotonic byte positions; the ring index is pos & mask
+    uint64_t tail;
+    uint64_t count;
+
+    uint8_t record[MAX_RECORD];
+
+    void WriteBytes(uint64_t pos, const uint8_t* data, size_t size);
+    void ReadBytes(uint64_t pos, uint8_t* data, size_t size) const;
+    uint16_t ReadLength(uint64_t pos) const;
+};
+
+#endif // UNDOLOG_H
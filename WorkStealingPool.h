@@ -0,0 +1,60 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool with one task deque per worker. A worker takes its newest task
+// from the back of its own deque and, once that is empty, steals the oldest
+// task from the front of another worker's, so uneven jobs (short and long
+// ROMs) still keep every core busy without a single contended queue.
+class WorkStealingPool {
+public:
+    // threadCount 0 uses every hardware thread
+    explicit WorkStealingPool(unsigned int threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Queue a task; tasks are spread round-robin over the workers
+    void Submit(std::function<void()> task);
+
+    // Block until every submitted task has finished
+    void Wait();
+
+    unsigned int GetThreadCount() const { return (unsigned int)threads.size(); }
+    uint64_t GetStealCount() const { return steals.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::atomic<unsigned int> nextWorker;
+    std::atomic<uint64_t> steals;
+
+    // Idle workers sleep on wake; Wait() sleeps on done
+    std::mutex stateMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::atomic<size_t> queued;         // Tasks sitting in a deque
+    std::atomic<size_t> unfinished;     // Tasks submitted but not finished
+    bool stopping;
+
+    bool TakeTask(unsigned int self, std::function<void()>& task);
+    void WorkerMain(unsigned int self);
+};
+
+#endif // WORKSTEALINGPOOL_H
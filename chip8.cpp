@@ -1,5 +1,6 @@
 // chip8.cpp - Improved version with bug fixes
 #include "chip8.h"
+#include "Breakpoints.h"
 #include <fstream>
 #include <iostream>
 #include <cstring>
@@ -9,6 +10,12 @@ const unsigned int FONTSET_SIZE = 80;
 const unsigned int FONTSET_START_ADDRESS = 0x50;
 const unsigned int MAX_ROM_SIZE = 4096 - START_ADDRESS;
 
+// Optional work in executeCycle, each combination is a separate instantiation
+const unsigned int FEATURE_WATCH = 1;          // Breakpoints and watchpoints armed
+const unsigned int FEATURE_COUNT_ACCESS = 2;   // Memory access counters attached
+const unsigned int FEATURE_PROVENANCE = 4;     // Pixel provenance buffer attached
+const unsigned int FEATURE_ALL = FEATURE_WATCH | FEATURE_COUNT_ACCESS | FEATURE_PROVENANCE;
+
 uint8_t fontset[FONTSET_SIZE] = {
     0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
     0x20, 0x60, 0x20, 0x20, 0x70, // 1
@@ -42,16 +49,16 @@ chip8::chip8() : randGen(std::chrono::system_clock::now().time_since_epoch().cou
 
     // Load fontset into memory
     for (unsigned int i = 0; i < FONTSET_SIZE; ++i) {
-        memory[FONTSET_START_ADDRESS + i] = fontset[i];
+        memory.Write(FONTSET_START_ADDRESS + i, fontset[i]);
     }
 }
 
-void chip8::LoadROM(char const* filename) {
+bool chip8::LoadROM(char const* filename) {
     std::ifstream file(filename, std::ios::binary | std::ios::ate);
 
     if (!file.is_open()) {
         std::cerr << "Failed to open ROM file: " << filename << std::endl;
-        return;
+        return false;
     }
 
     std::streampos size = file.tellg();
@@ -60,7 +67,7 @@ void chip8::LoadROM(char const* filename) {
         std::cerr << "ROM size (" << size << " bytes) exceeds maximum allowed size ("
                   << MAX_ROM_SIZE << " bytes)" << std::endl;
         file.close();
-        return;
+        return false;
     }
 
     char* buffer = new char[size];
@@ -68,17 +75,27 @@ void chip8::LoadROM(char const* filename) {
     file.read(buffer, size);
     file.close();
 
-    // Load ROM into memory starting at 0x200
-    for (long i = 0; i < size; ++i) {
-        memory[START_ADDRESS + i] = static_cast<uint8_t>(buffer[i]);
-    }
+    LoadROM(reinterpret_cast<const uint8_t*>(buffer), (size_t)size);
 
     delete[] buffer;
     std::cout << "Loaded ROM: " << filename << " (" << size << " bytes)" << std::endl;
+    return true;
+}
+
+bool chip8::LoadROM(const uint8_t* data, size_t size) {
+    if (size > MAX_ROM_SIZE) {
+        std::cerr << "ROM size (" << size << " bytes) exceeds maximum allowed size ("
+                  << MAX_ROM_SIZE << " bytes)" << std::endl;
+        return false;
+    }
+
+    // Load ROM into memory starting at 0x200
+    memory.Write(START_ADDRESS, data, size);
+    return true;
 }
 
 void chip8::resetMemory() {
-    std::memset(memory, 0, sizeof(memory));
+    memory.Fill(0);
 }
 
 void chip8::resetRegistersV() {
@@ -86,13 +103,173 @@ void chip8::resetRegistersV() {
 }
 
 void chip8::clear_display() {
-    std::memset(graphics, 0, sizeof(graphics));
+    std::memset(graphics.Writable(), 0, FrameBuffer::PIXELS * sizeof(uint32_t));
 }
 
 void chip8::emulateCycle() {
+    // Only pay for debugging and profiling checks while they are in use
+    unsigned int features = ((breakpoints && breakpoints->IsArmed()) ? FEATURE_WATCH : 0) |
+                            (access_counts ? FEATURE_COUNT_ACCESS : 0) |
+                            (pixel_origins ? FEATURE_PROVENANCE : 0);
+
+    // Every combination needs its case; a new feature must extend the switch
+    static_assert(FEATURE_ALL == 7, "emulateCycle() does not dispatch every feature combination");
+
+    switch (features) {
+        case 0:
+            executeCycle<0>();
+            break;
+        case FEATURE_WATCH:
+            executeCycle<FEATURE_WATCH>();
+            break;
+        case FEATURE_COUNT_ACCESS:
+            executeCycle<FEATURE_COUNT_ACCESS>();
+            break;
+        case FEATURE_WATCH | FEATURE_COUNT_ACCESS:
+            executeCycle<FEATURE_WATCH | FEATURE_COUNT_ACCESS>();
+            break;
+        case FEATURE_PROVENANCE:
+            executeCycle<FEATURE_PROVENANCE>();
+            break;
+        case FEATURE_WATCH | FEATURE_PROVENANCE:
+            executeCycle<FEATURE_WATCH | FEATURE_PROVENANCE>();
+            break;
+        case FEATURE_COUNT_ACCESS | FEATURE_PROVENANCE:
+            executeCycle<FEATURE_COUNT_ACCESS | FEATURE_PROVENANCE>();
+            break;
+        case FEATURE_ALL:
+            executeCycle<FEATURE_ALL>();
+            break;
+    }
+}
+
+chip8 chip8::clone() const {
+    chip8 copy(*this);
+    copy.breakpoints = nullptr;
+    copy.access_counts = nullptr;
+    copy.pixel_origins = nullptr;
+    copy.break_reason = BreakReason::None;
+    copy.resume_from_break = false;
+    return copy;
+}
+
+bool chip8::emulateFrame(unsigned int cycles) {
+    for (unsigned int i = 0; i < cycles; ++i) {
+        emulateCycle();
+        if (break_reason != BreakReason::None) {
+            return false;
+        }
+    }
+
+    endFrame();
+    return true;
+}
+
+uint64_t chip8::hashGraphics() const {
+    uint64_t hash = 14695981039346656037ull;
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(graphics.data());
+    for (size_t i = 0; i < FrameBuffer::PIXELS * sizeof(uint32_t); ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t chip8::hashState() const {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t word) { hash = (hash ^ word) * 1099511628211ull; };
+
+    for (int i = 0; i < 16; ++i) {
+        mix((uint64_t)registers_V[i] << 16 | stack[i]);
+    }
+    mix((uint64_t)index_register << 48 | (uint64_t)program_counter << 32 | (uint64_t)stack_pointer << 16 |
+        (uint64_t)delay_timer << 8 | sound_timer);
+
+    // The next draw from a copy stands in for the generator's internal state
+    std::default_random_engine nextRand = randGen;
+    mix(nextRand());
+
+    uint8_t bytes[PagedMemory::SIZE];
+    memory.Read(0, bytes, sizeof(bytes));
+    for (size_t i = 0; i < sizeof(bytes); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        mix(word);
+    }
+
+    // One bit per pixel, one word per row
+    const uint32_t* pixels = graphics.data();
+    for (unsigned int y = 0; y < VIDEO_HEIGHT; ++y) {
+        uint64_t row = 0;
+        for (unsigned int x = 0; x < VIDEO_WIDTH; ++x) {
+            row |= (uint64_t)(pixels[y * VIDEO_WIDTH + x] != 0) << x;
+        }
+        mix(row);
+    }
+    return hash;
+}
+
+void chip8::reportUnknownOpcode() {
+    ++unknown_opcodes;
+    if (log_unknown_opcodes) {
+        std::cerr << std::hex << "Unknown opcode: 0x" << opcode << " at 0x" << (program_counter - 2)
+                  << std::dec << std::endl;
+    }
+}
+
+void chip8::resumeFromBreak() {
+    // Only a breakpoint stops before its instruction; after a pause or a
+    // watchpoint, a breakpoint at PC has not been hit yet
+    resume_from_break = break_reason == BreakReason::Breakpoint;
+    break_reason = BreakReason::None;
+}
+
+template <unsigned Features>
+void chip8::executeCycle() {
+    if constexpr ((Features & FEATURE_WATCH) != 0) {
+        if (!resume_from_break && breakpoints->ShouldBreak(*this, program_counter)) {
+            break_reason = BreakReason::Breakpoint;
+            break_address = program_counter;
+            return;
+        }
+    }
+    // Also cleared while unarmed, so it can't skip a breakpoint armed later
+    resume_from_break = false;
+
+    // Data accesses: watchpoints let the instruction finish and report the
+    // first access, counters record every one
+    auto noteRead = [this](uint16_t address) {
+        if constexpr ((Features & FEATURE_WATCH) != 0) {
+            if (break_reason == BreakReason::None && breakpoints->IsReadWatched(address)) {
+                break_reason = BreakReason::ReadWatch;
+                break_address = address;
+            }
+        }
+        if constexpr ((Features & FEATURE_COUNT_ACCESS) != 0) {
+            ++access_counts->reads[address & 0xFFF];
+        }
+        (void)address;
+    };
+    auto noteWrite = [this](uint16_t address) {
+        if constexpr ((Features & FEATURE_WATCH) != 0) {
+            if (break_reason == BreakReason::None && breakpoints->IsWriteWatched(address)) {
+                break_reason = BreakReason::WriteWatch;
+                break_address = address;
+            }
+        }
+        if constexpr ((Features & FEATURE_COUNT_ACCESS) != 0) {
+            ++access_counts->writes[address & 0xFFF];
+        }
+        (void)address;
+    };
+
     // Fetch instruction
-    opcode = (memory[program_counter] << 8) | memory[program_counter + 1];
+    opcode = memory.Read16(program_counter);
+    if constexpr ((Features & FEATURE_COUNT_ACCESS) != 0) {
+        ++access_counts->reads[program_counter & 0xFFF];
+        ++access_counts->reads[(program_counter + 1) & 0xFFF];
+    }
     program_counter += 2;
+    ++cycle_count;
 
     // Decode and execute
     switch (opcode & 0xF000) {
@@ -107,7 +284,7 @@ void chip8::emulateCycle() {
                     }
                     break;
                 default:
-                    std::cout << "Unknown 0x0 opcode: 0x" << std::hex << opcode << std::endl;
+                    reportUnknownOpcode();
             }
             break;
 
@@ -188,7 +365,7 @@ void chip8::emulateCycle() {
                     registers_V[x] <<= 1;
                     break;
                 default:
-                    std::cout << "Unknown 0x8 opcode: 0x" << std::hex << opcode << std::endl;
+                    reportUnknownOpcode();
             }
             break;
         }
@@ -218,14 +395,18 @@ void chip8::emulateCycle() {
 
             registers_V[0xF] = 0; // Reset collision flag
 
+            // Unshare the framebuffer from any clone before drawing
+            uint32_t* pixels = graphics.Writable();
+
             for (uint8_t row = 0; row < height; ++row) {
                 uint8_t spriteByte = memory[index_register + row];
+                noteRead(index_register + row);
 
                 for (uint8_t col = 0; col < 8; ++col) {
                     if (spriteByte & (0x80 >> col)) {
                         uint16_t pixelX = (x + col) % VIDEO_WIDTH;
                         uint16_t pixelY = (y + row) % VIDEO_HEIGHT;
-                        uint32_t* screenPixel = &graphics[pixelY * VIDEO_WIDTH + pixelX];
+                        uint32_t* screenPixel = &pixels[pixelY * VIDEO_WIDTH + pixelX];
 
                         // Check for collision before XOR
                         if (*screenPixel != 0) {
@@ -234,6 +415,12 @@ void chip8::emulateCycle() {
 
                         // XOR the pixel (toggle it)
                         *screenPixel ^= 0xFFFFFFFF;
+
+                        if constexpr ((Features & FEATURE_PROVENANCE) != 0) {
+                            pixel_origins[pixelY * VIDEO_WIDTH + pixelX] = {
+                                (uint16_t)(program_counter - 2), index_register, (uint32_t)frame_count
+                            };
+                        }
                     }
                 }
             }
@@ -254,7 +441,7 @@ void chip8::emulateCycle() {
                     }
                     break;
                 default:
-                    std::cout << "Unknown 0xE opcode: 0x" << std::hex << opcode << std::endl;
+                    reportUnknownOpcode();
             }
             break;
         }
@@ -293,29 +480,34 @@ void chip8::emulateCycle() {
                     break;
                 case 0x33: { // LD B, Vx - Store BCD representation
                     uint8_t value = registers_V[x];
-                    memory[index_register] = value / 100;
-                    memory[index_register + 1] = (value / 10) % 10;
-                    memory[index_register + 2] = value % 10;
+                    memory.Write(index_register, value / 100);
+                    memory.Write(index_register + 1, (value / 10) % 10);
+                    memory.Write(index_register + 2, value % 10);
+                    noteWrite(index_register);
+                    noteWrite(index_register + 1);
+                    noteWrite(index_register + 2);
                     break;
                 }
                 case 0x55: // LD [I], Vx - Store registers V0-Vx
                     for (int i = 0; i <= x; ++i) {
-                        memory[index_register + i] = registers_V[i];
+                        memory.Write(index_register + i, registers_V[i]);
+                        noteWrite(index_register + i);
                     }
                     break;
                 case 0x65: // LD Vx, [I] - Load registers V0-Vx
                     for (int i = 0; i <= x; ++i) {
                         registers_V[i] = memory[index_register + i];
+                        noteRead(index_register + i);
                     }
                     break;
                 default:
-                    std::cout << "Unknown 0xF opcode: 0x" << std::hex << opcode << std::endl;
+                    reportUnknownOpcode();
             }
             break;
         }
 
         default:
-            std::cout << "Unknown opcode: 0x" << std::hex << opcode << std::endl;
+            reportUnknownOpcode();
             break;
     }
 
@@ -324,10 +516,8 @@ void chip8::emulateCycle() {
         --delay_timer;
     }
 
+    // The frontend turns a non-zero sound timer into audio output
     if (sound_timer > 0) {
-        if (sound_timer == 1) {
-            std::cout << "BEEP!" << std::endl;
-        }
         --sound_timer;
     }
 }
\ No newline at end of file
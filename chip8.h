@@ -5,17 +5,48 @@
 #ifndef CHIP8_H
 #define CHIP8_H
 #include <cstdint>
+#include <cstddef>
 #include <chrono>
 #include <random>
+#include "CopyOnWrite.h"
 
 const unsigned int VIDEO_HEIGHT = 32;
 const unsigned int VIDEO_WIDTH = 64;
 
+// CXNN's random byte. LockstepEngine uses the same type, so its lanes draw
+// the same numbers as chip8 from the same generator state. (uint8_t is not a
+// valid type for the distribution and MSVC rejects it.)
+typedef std::uniform_int_distribution<unsigned int> RandByteDistribution;
+
+class Breakpoints;
+
+// Per-address memory access counters, filled while attached to a chip8
+struct MemoryAccessCounts {
+    uint32_t reads[4096];
+    uint32_t writes[4096];
+};
+
+// Last DXYN that toggled a pixel
+struct PixelOrigin {
+    uint16_t pc;        // Address of the DXYN instruction
+    uint16_t index;     // I when it ran (the sprite data)
+    uint32_t frame;     // frame_count when it ran
+};
+
+// Why the last emulateCycle() stopped
+enum class BreakReason : uint8_t {
+    None,
+    Breakpoint,     // PC hit a breakpoint; the instruction was not executed
+    ReadWatch,      // The instruction read a watched address
+    WriteWatch      // The instruction wrote a watched address
+};
+
 class chip8 {
     public:
         uint8_t registers_V[16]{};
-        uint8_t memory[4096]{};
-        uint32_t graphics[64*32]{};
+        // Shared copy-on-write between clones; writes go through Write()/Writable()
+        PagedMemory memory;
+        FrameBuffer graphics;
         uint8_t keypad[16]{};
 
         uint8_t delay_timer{};
@@ -27,12 +58,39 @@ class chip8 {
         uint16_t program_counter{};
         uint16_t opcode{};
 
+        uint64_t cycle_count{};
+        uint64_t frame_count{};
+
+        // Invalid instructions are counted (and skipped); printing them to
+        // stderr is opt-in so batch and pool workers stay quiet
+        uint64_t unknown_opcodes{};
+        bool log_unknown_opcodes{};
+
+        // Debugging: consulted only while breakpoints are armed
+        Breakpoints* breakpoints{};
+        BreakReason break_reason{};
+        uint16_t break_address{};
+        bool resume_from_break{};
+
+        // Optional memory access profiling (instruction fetches count as reads)
+        MemoryAccessCounts* access_counts{};
+
+        // Optional pixel provenance, one entry per graphics pixel
+        PixelOrigin* pixel_origins{};
+
         std::default_random_engine randGen;
-        std::uniform_int_distribution<uint8_t> randByte;
+        RandByteDistribution randByte;
 
         chip8();
 
-        void LoadROM(char const *filename);
+        bool LoadROM(char const *filename);
+
+        // Copy that shares memory pages and the framebuffer until either side
+        // writes them. Debugging and profiling attachments are not carried over.
+        chip8 clone() const;
+
+        // Load a ROM image already in memory (no file access, no logging)
+        bool LoadROM(const uint8_t* data, size_t size);
 
         void resetMemory();
 
@@ -42,6 +100,31 @@ class chip8 {
 
 
         void emulateCycle();
+
+        // Run up to cycles cycles, then endFrame(); returns false if a break stopped it early
+        bool emulateFrame(unsigned int cycles);
+
+        // Called by the frontend after each presented frame
+        void endFrame() { ++frame_count; }
+
+        // FNV-1a over the framebuffer, for comparing runs without keeping frames
+        uint64_t hashGraphics() const;
+
+        // Hash of everything that decides future execution: registers, stack,
+        // timers, memory, display and the random generator. Keypad and the
+        // cycle/frame counters are left out, so equal states at different
+        // times (or with different keys about to be pressed) hash the same.
+        uint64_t hashState() const;
+
+        // Clear the last break; after a breakpoint, the next cycle runs past it
+        void resumeFromBreak();
+
+    private:
+        void reportUnknownOpcode();
+
+        // Features selects the optional per-instruction work compiled in
+        template <unsigned Features>
+        void executeCycle();
 };
 
 
@@ -1,12 +1,25 @@
 #include "chip8.h"
 #include "PlatformSDL.h"
 #include "DebugSDL.h"
+#include "EventDispatcherSDL.h"
+#include "AudioSDL.h"
+#include "InputQueue.h"
+#include "Recorder.h"
+#include "StateSnapshot.h"
+#include "Breakpoints.h"
+#include "DebugCommands.h"
+#include "UndoLog.h"
+#include "GdbStub.h"
 #include <SDL3_ttf/SDL_ttf.h>
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <memory>
 #include <cstring>
+#include <algorithm>
+
+// Upper bound on cycles run per loop iteration in audio sync mode
+const int MAX_CYCLES_PER_ITERATION = 1000;
 
 void showSplashScreen() {
     // Initialize SDL for splash screen
@@ -233,24 +246,102 @@ splash_end:
 
 int main(int argc, char** argv)
 {
-    if (argc < 4 || argc > 5)
+    if (argc < 4)
     {
-        std::cerr << "Usage: " << argv[0] << " <Scale> <Delay> <ROM> [debug]\n";
+        std::cerr << "Usage: " << argv[0] << " <Scale> <Delay> <ROM> [debug] [--record <file>] [--audio-buffer <frames>] [--mute] [--sync wall|audio] [--break <addr>[:<cond>]] [--watch <addr>[:r|w|rw]] [--heatmap] [--provenance] [--gdb <port|unix:path>] [--no-splash] [--run-ahead <frames>]\n";
         std::cerr << "  Scale: Display scale factor (1-20 recommended)\n";
         std::cerr << "  Delay: Cycle delay in milliseconds (recommended: 1-10)\n";
         std::cerr << "  ROM: Path to the CHIP-8 ROM file\n";
         std::cerr << "  debug: Optional - add 'debug' to enable debug window\n";
+        std::cerr << "  --record: Optional - capture gameplay to an animated .gif (any other extension: raw sequence)\n";
+        std::cerr << "  --audio-buffer: Optional - audio device buffer in sample frames (default 512, lower = less latency)\n";
+        std::cerr << "  --mute: Optional - disable audio output\n";
+        std::cerr << "  --sync: Optional - pace emulation by the wall clock (default) or by audio consumption\n";
+        std::cerr << "  --break: Optional - pause at an address, e.g. 0x2A4 or \"0x2A4:V3 == 0x10 && I > 0x300\"\n";
+        std::cerr << "  --watch: Optional - pause after an instruction reads and/or writes an address (default rw)\n";
+        std::cerr << "  --heatmap: Optional - count memory reads/writes per address for the debugger heat map (H)\n";
+        std::cerr << "  --provenance: Optional - remember which instruction drew each pixel (hover the debugger display)\n";
+        std::cerr << "  --gdb: Optional - serve the GDB remote protocol on localhost:<port> or a Unix socket\n";
+        std::cerr << "  --no-splash: Optional - start without the splash screen\n";
+        std::cerr << "  --run-ahead: Optional - show the display this many 60 Hz frames ahead, hiding input lag\n";
         std::exit(EXIT_FAILURE);
     }
 
-    // Show splash screen
     std::cout << "CIPPOTTO v2.1 by VikSn0w" << std::endl;
-    showSplashScreen();
 
     int videoScale = std::stoi(argv[1]);
     int cycleDelay = std::stoi(argv[2]);
     char const* romFilename = argv[3];
-    bool enableDebug = (argc == 5 && std::string(argv[4]) == "debug");
+    bool enableDebug = false;
+    char const* recordFilename = nullptr;
+    int audioBufferFrames = 512;
+    bool enableAudio = true;
+    bool audioSync = false;
+    Breakpoints breakpoints;
+    bool profileMemory = false;
+    bool trackProvenance = false;
+    char const* gdbAddress = nullptr;
+    bool showSplash = true;
+    int runAheadFrames = 0;
+
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "debug") {
+            enableDebug = true;
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordFilename = argv[++i];
+        } else if (arg == "--audio-buffer" && i + 1 < argc) {
+            audioBufferFrames = std::stoi(argv[++i]);
+        } else if (arg == "--gdb" && i + 1 < argc) {
+            gdbAddress = argv[++i];
+        } else if (arg == "--run-ahead" && i + 1 < argc) {
+            runAheadFrames = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--no-splash") {
+            showSplash = false;
+        } else if (arg == "--mute") {
+            enableAudio = false;
+        } else if (arg == "--break" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            size_t colon = spec.find(':');
+            uint16_t address = (uint16_t)std::stoi(spec.substr(0, colon), nullptr, 0);
+            BreakCondition condition;
+            if (colon != std::string::npos) {
+                std::string error;
+                condition = Breakpoints::CompileCondition(spec.substr(colon + 1), &error);
+                if (!condition) {
+                    std::cerr << "Bad breakpoint condition: " << error << std::endl;
+                    std::exit(EXIT_FAILURE);
+                }
+            }
+            breakpoints.SetBreakpoint(address, condition);
+        } else if (arg == "--watch" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            size_t colon = spec.find(':');
+            uint16_t address = (uint16_t)std::stoi(spec.substr(0, colon), nullptr, 0);
+            std::string mode = (colon != std::string::npos) ? spec.substr(colon + 1) : "rw";
+            breakpoints.SetWatch(address, mode.find('r') != std::string::npos, mode.find('w') != std::string::npos);
+        } else if (arg == "--heatmap") {
+            profileMemory = true;
+        } else if (arg == "--provenance") {
+            trackProvenance = true;
+        } else if (arg == "--sync" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "audio") {
+                audioSync = true;
+            } else if (mode != "wall") {
+                std::cerr << "Unknown sync mode: " << mode << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    // Show splash screen
+    if (showSplash) {
+        showSplashScreen();
+    }
 
     // Clamp video scale to reasonable values
     if (videoScale < 1) videoScale = 1;
@@ -261,16 +352,57 @@ int main(int argc, char** argv)
                         VIDEO_WIDTH * videoScale, VIDEO_HEIGHT * videoScale,
                         VIDEO_WIDTH, VIDEO_HEIGHT);
 
+    // Initialize audio output
+    AudioSDL audio;
+    if (enableAudio && !audio.Initialize(48000, audioBufferFrames, audioSync)) {
+        std::cerr << "Continuing without audio" << std::endl;
+    }
+
+    if (audioSync && !audio.IsMasterClock()) {
+        std::cerr << "Audio sync needs audio output, falling back to wall clock pacing" << std::endl;
+        audioSync = false;
+    }
+
+    // The audio clock needs a finite cycle rate to pace against
+    if (audioSync && cycleDelay < 1) {
+        cycleDelay = 1;
+    }
+
+    // A run-ahead frame is 1/60 s worth of cycles at the chosen delay
+    int runAheadCycles = runAheadFrames * std::max(1, (int)(1000.0 / 60.0 / std::max(cycleDelay, 1)));
+
     // Initialize CHIP-8 emulator
     chip8 chip8;
     chip8.LoadROM(romFilename);
+    chip8.breakpoints = &breakpoints;
+    chip8.log_unknown_opcodes = true;
+
+    // Per-address access counters, only allocated (and paid for) on request
+    std::unique_ptr<MemoryAccessCounts> accessCounts;
+    if (profileMemory) {
+        accessCounts = std::make_unique<MemoryAccessCounts>();
+        chip8.access_counts = accessCounts.get();
+    }
 
-    // Initialize debug window if requested
+    // Pixel provenance costs one store per drawn pixel, only when enabled
+    std::unique_ptr<PixelOrigin[]> pixelOrigins;
+    if (trackProvenance) {
+        pixelOrigins = std::make_unique<PixelOrigin[]>(VIDEO_WIDTH * VIDEO_HEIGHT);
+        chip8.pixel_origins = pixelOrigins.get();
+    }
+
+    // Initialize debug window if requested. It is drawn from the main loop at
+    // its own refresh rate and only sees the state snapshots published after each frame.
+    SnapshotBuffer snapshots;
+    DebugCommandQueue debugCommands;
+    std::unique_ptr<UndoLog> undoLog;
     std::unique_ptr<DebugSDL> debugWindow;
     if (enableDebug) {
         debugWindow = std::make_unique<DebugSDL>();
-        if (debugWindow->Initialize("CHIP-8 Debugger", 1200, 800)) {
+        snapshots.Publish(chip8);
+        if (debugWindow->Start("CHIP-8 Debugger", 1200, 800, snapshots, &debugCommands, 30)) {
             std::cout << "Debug window enabled!" << std::endl;
+            undoLog = std::make_unique<UndoLog>();
             std::cout << "Debug Controls:" << std::endl;
             std::cout << "  F1-F6: Toggle debug sections" << std::endl;
             std::cout << "  F: Toggle follow PC mode" << std::endl;
@@ -278,6 +410,9 @@ int main(int argc, char** argv)
             std::cout << "  Page Up/Down: Large memory navigation" << std::endl;
             std::cout << "  Home: Go to program start" << std::endl;
             std::cout << "  R: Reset to follow PC" << std::endl;
+            std::cout << "  Space: Pause/continue, N: Step, P: Step back, B: Breakpoint at PC" << std::endl;
+            std::cout << "  Click disassembly: Toggle breakpoint" << std::endl;
+            std::cout << "  H: Toggle memory heat map (needs --heatmap)" << std::endl;
             std::cout << "  Tab/Escape: Toggle debug visibility" << std::endl;
         } else {
             std::cerr << "Failed to initialize debug window" << std::endl;
@@ -285,11 +420,114 @@ int main(int argc, char** argv)
         }
     }
 
+    // Remote debug stub, serviced once per loop iteration between cycles
+    std::unique_ptr<GdbStub> gdbStub;
+    if (gdbAddress) {
+        gdbStub = std::make_unique<GdbStub>();
+        if (gdbStub->Listen(gdbAddress)) {
+            if (!undoLog) {
+                undoLog = std::make_unique<UndoLog>();
+            }
+        } else {
+            gdbStub.reset();
+        }
+    }
+
+    // Start background recording if requested
+    Recorder recorder;
+    if (recordFilename) {
+        recorder.Start(recordFilename, VIDEO_WIDTH, VIDEO_HEIGHT);
+    }
+
     int videoPitch = sizeof(chip8.graphics[0]) * VIDEO_WIDTH;
 
     auto lastCycleTime = std::chrono::high_resolution_clock::now();
+    double cycleBudget = 0.0;
     bool quit = false;
 
+    // Keypad changes queued by the platform and applied at a defined cycle
+    InputQueue input;
+
+    // Run control: set by breakpoints or the debugger, cleared by continue
+    bool paused = false;
+    int pendingSteps = 0;
+    std::vector<DebugCommand> commands;
+
+    auto runCycle = [&]() {
+        // Apply key changes due at this cycle
+        input.Apply(chip8.keypad, chip8.cycle_count);
+
+        // Execute one CHIP-8 cycle, keeping what it overwrites for reverse stepping
+        if (undoLog) {
+            undoLog->Record(chip8);
+        }
+        chip8.emulateCycle();
+
+        if (undoLog && chip8.break_reason == BreakReason::Breakpoint) {
+            // Stopped before executing anything
+            undoLog->DropLast();
+        }
+
+        if (chip8.break_reason != BreakReason::None) {
+            paused = true;
+            std::cout << "Break at PC 0x" << std::hex << chip8.program_counter
+                      << " (address 0x" << chip8.break_address << ")" << std::dec << std::endl;
+        }
+
+        // Publish the sound timer state to the audio thread
+        audio.SetTone(chip8.sound_timer > 0);
+    };
+
+    // Run-ahead cost, reported on exit
+    double runAheadMs = 0.0;
+    uint64_t runAheadCount = 0;
+
+    auto presentFrame = [&]() {
+        // Update main display. With run-ahead, show a copy-on-write clone run
+        // forward with the current keys; the real state is never touched, so
+        // there is nothing to restore. Recorder and debugger see the real frame.
+        if (runAheadCycles > 0 && !paused) {
+            auto start = std::chrono::high_resolution_clock::now();
+            auto ahead = chip8.clone();
+            for (int i = 0; i < runAheadCycles; ++i) {
+                ahead.emulateCycle();
+            }
+            platform.Update(ahead.graphics, videoPitch);
+            runAheadMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            ++runAheadCount;
+        } else {
+            platform.Update(chip8.graphics, videoPitch);
+        }
+        input.OnPresent(SDL_GetTicksNS());
+
+        // Hand the finished frame to the recorder (never blocks)
+        if (recorder.IsRecording()) {
+            recorder.SubmitFrame(chip8.graphics);
+        }
+
+        // Hand a consistent copy of the state to the debugger
+        if (debugWindow) {
+            snapshots.Publish(chip8, paused);
+        }
+
+        chip8.endFrame();
+    };
+
+    // Single event pump routing by window: main window keys go to the input
+    // queue, debugger events to the debugger
+    EventDispatcherSDL events;
+
+    events.Register(platform.GetWindowID(), [&](const SDL_Event& e) {
+        return platform.HandleEvent(e, input, chip8.cycle_count);
+    });
+
+    if (debugWindow) {
+        events.Register(debugWindow->GetWindowID(), [&](const SDL_Event& e) {
+            debugWindow->PostEvent(e);
+            return false;
+        });
+    }
+
     std::cout << "Starting emulation..." << std::endl;
     if (debugWindow) {
         std::cout << "Debug mode enabled - separate debug window is available" << std::endl;
@@ -297,42 +535,132 @@ int main(int argc, char** argv)
 
     while (!quit)
     {
-        // Handle main window input
-        quit = platform.ProcessInput(chip8.keypad);
-
-        // Handle debug window events if enabled
-        bool debugQuit = false;
-        if (debugWindow && debugWindow->IsEnabled()) {
-            debugQuit = debugWindow->HandleEvents();
-            if (debugQuit) {
-                // User closed debug window, but continue emulation
-                debugWindow->SetEnabled(false);
-                std::cout << "Debug window closed (emulation continues)" << std::endl;
+        // Poll events once for all windows
+        quit = events.Pump();
+
+        if (debugWindow && debugWindow->IsCloseRequested()) {
+            // User closed debug window, but continue emulation
+            events.Unregister(debugWindow->GetWindowID());
+            debugWindow->Stop();
+            debugWindow->Shutdown();
+            debugWindow.reset();
+            std::cout << "Debug window closed (emulation continues)" << std::endl;
+        }
+
+        if (gdbStub) {
+            gdbStub->Poll(chip8, breakpoints, debugCommands);
+            quit = quit || gdbStub->IsKillRequested();
+        }
+
+        // Apply debugger run control between cycles
+        debugCommands.Drain(commands);
+        for (const DebugCommand& command : commands) {
+            switch (command.type) {
+                case DebugCommandType::Pause:
+                    paused = true;
+                    break;
+                case DebugCommandType::Continue:
+                    paused = false;
+                    pendingSteps = 0;
+                    chip8.resumeFromBreak();
+                    break;
+                case DebugCommandType::Step:
+                    if (paused) ++pendingSteps;
+                    break;
+                case DebugCommandType::StepBack:
+                    paused = true;
+                    pendingSteps = 0;
+                    if (!undoLog || !undoLog->StepBack(chip8)) {
+                        std::cout << "Nothing to step back to" << std::endl;
+                    }
+                    break;
+                case DebugCommandType::ToggleBreakpoint:
+                    breakpoints.ToggleBreakpoint(command.address);
+                    break;
             }
         }
 
+        if (paused) {
+            audio.SetTone(false);
+        }
+
         auto currentTime = std::chrono::high_resolution_clock::now();
         float dt = std::chrono::duration<float, std::chrono::milliseconds::period>(currentTime - lastCycleTime).count();
 
-        if (dt > cycleDelay)
+        int cyclesRun = 0;
+
+        if (audioSync)
         {
+            // Advance by elapsed time scaled by the audio rate control, so the
+            // device's consumption is the long-run clock without bursty catch-up
             lastCycleTime = currentTime;
+            cycleBudget += dt / (double)cycleDelay * audio.GetRateAdjustment();
 
-            // Execute one CHIP-8 cycle
-            chip8.emulateCycle();
+            // Refill to target immediately if the queue is about to run dry
+            int queuedFrames = audio.GetQueuedFrames();
+            if (queuedFrames < audio.GetTargetFrames() / 2) {
+                double framesPerCycle = audio.GetSampleRate() * (double)cycleDelay / 1000.0;
+                cycleBudget = std::max(cycleBudget, (audio.GetTargetFrames() - queuedFrames) / framesPerCycle);
+            }
 
-            // Update main display
-            platform.Update(chip8.graphics, videoPitch);
+            while (!paused && cycleBudget >= 1.0 && cyclesRun < MAX_CYCLES_PER_ITERATION) {
+                runCycle();
+                audio.QueueCycle((double)cycleDelay);
+                cycleBudget -= 1.0;
+                ++cyclesRun;
 
-            // Update debug window if enabled
-            if (debugWindow) {
-                debugWindow->Update(&chip8);
+                if (audio.GetQueuedFrames() >= audio.GetTargetFrames() * 2) {
+                    break;
+                }
             }
+
+            // Do not carry a backlog after a long stall
+            cycleBudget = std::min(cycleBudget, 1.0);
+        }
+        else if (paused)
+        {
+            // Resume from now rather than catching up on the pause
+            lastCycleTime = currentTime;
+            cycleBudget = 0.0;
         }
+        else
+        {
+            // Catch up on cycles due while the loop was busy (e.g. drawing the
+            // debugger frame), so a slow pass doesn't slow emulated time
+            lastCycleTime = currentTime;
+            cycleBudget = cycleDelay > 0 ? cycleBudget + dt / (double)cycleDelay : 1.0;
 
-        // Render debug window if enabled
-        if (debugWindow && debugWindow->IsEnabled()) {
-            debugWindow->Render();
+            while (!paused && cycleBudget >= 1.0 && cyclesRun < MAX_CYCLES_PER_ITERATION) {
+                runCycle();
+                cycleBudget -= 1.0;
+                ++cyclesRun;
+            }
+
+            // Do not carry a backlog after a long stall
+            cycleBudget = std::min(cycleBudget, 1.0);
+        }
+
+        // Single steps requested while paused
+        while (paused && pendingSteps > 0) {
+            --pendingSteps;
+            chip8.resumeFromBreak();
+            runCycle();
+            ++cyclesRun;
+        }
+
+        // Stop reply for a remote client waiting on continue or step
+        if (gdbStub && paused) {
+            gdbStub->NotifyStopped(chip8);
+        }
+
+        if (cyclesRun > 0 || !commands.empty())
+        {
+            presentFrame();
+        }
+
+        // Debugger frame, at its own refresh rate
+        if (debugWindow) {
+            debugWindow->Tick();
         }
 
         // Reduce CPU usage but keep responsive
@@ -340,7 +668,20 @@ int main(int argc, char** argv)
     }
 
     // Cleanup
+    input.PrintLatencyReport();
+    if (runAheadCount > 0) {
+        std::cout << "Run-ahead: " << runAheadFrames << " frames (" << runAheadCycles << " cycles), "
+                  << runAheadMs / runAheadCount * 1000.0 << " us per presented frame" << std::endl;
+    }
+    recorder.Stop();
+    audio.Shutdown();
+
+    if (gdbStub) {
+        gdbStub->Close();
+    }
+
     if (debugWindow) {
+        debugWindow->Stop();
         debugWindow->Shutdown();
         std::cout << "Debug window shut down" << std::endl;
     }
@@ -0,0 +1,93 @@
+/* Drives the cippotto library through its exported C API only: load a ROM,
+ * step, take a snapshot, step on, restore it, and check that the framebuffer
+ * and counters are back to where the snapshot was taken, in the same handle
+ * and in a second one. */
+#include "Cippotto.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PIXELS (CIPPOTTO_SCREEN_WIDTH * CIPPOTTO_SCREEN_HEIGHT)
+
+static int failures = 0;
+
+static void check(int ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+static int lit_pixels(const uint32_t* pixels) {
+    int lit = 0;
+    for (int i = 0; i < PIXELS; ++i) {
+        lit += pixels[i] != 0;
+    }
+    return lit;
+}
+
+int main(void)
+{
+    static const uint8_t rom[] = {
+        0x60, 0x00,     /* V0 = 0 */
+        0xF0, 0x29,     /* I = font digit V0 */
+        0xD0, 0x05,     /* Draw it at (V0, V0) */
+        0x70, 0x01,     /* V0 += 1 */
+        0xF0, 0x29,
+        0xD0, 0x05,     /* Digit 1 at (1, 1), over the 0 */
+        0x00, 0xE0,     /* CLS */
+        0x12, 0x0E,     /* Loop here */
+    };
+    static uint32_t saved[PIXELS];
+
+    check(cippotto_abi_version() == CIPPOTTO_ABI_VERSION, "ABI version");
+
+    cippotto* emu = cippotto_create(1);
+    cippotto* other = cippotto_create(2);
+    if (!emu || !other) {
+        fprintf(stderr, "cippotto_create failed\n");
+        return EXIT_FAILURE;
+    }
+    check(cippotto_load_rom(emu, rom, sizeof(rom)) == 0, "load ROM");
+
+    check(cippotto_step_instructions(emu, 3) == 0, "step to the first sprite");
+    memcpy(saved, cippotto_framebuffer(emu), sizeof(saved));
+    check(lit_pixels(saved) > 0, "first sprite drawn");
+
+    cippotto_snapshot* snapshot = cippotto_snapshot_create(emu);
+    check(snapshot != NULL, "snapshot create");
+    if (!snapshot) {
+        return EXIT_FAILURE;
+    }
+
+    /* Draw over the first sprite, then clear the screen */
+    check(cippotto_step_instructions(emu, 3) == 0, "step to the second sprite");
+    check(memcmp(saved, cippotto_framebuffer(emu), sizeof(saved)) != 0, "second sprite changes the display");
+    check(cippotto_step_frames(emu, 2, 10) == 0, "step frames");
+    check(lit_pixels(cippotto_framebuffer(emu)) == 0, "display cleared");
+
+    check(cippotto_snapshot_restore(emu, snapshot) == 0, "restore");
+    check(memcmp(saved, cippotto_framebuffer(emu), sizeof(saved)) == 0, "framebuffer restored");
+    check(cippotto_cycle_count(emu) == 3, "cycle count restored");
+    check(cippotto_frame_count(emu) == 0, "frame count restored");
+
+    /* The same snapshot in another handle, and stepping one doesn't touch the other */
+    check(cippotto_snapshot_restore(other, snapshot) == 0, "restore into a second handle");
+    check(memcmp(saved, cippotto_framebuffer(other), sizeof(saved)) == 0, "second handle framebuffer");
+    check(cippotto_step_instructions(other, 4) == 0, "step the second handle");
+    check(memcmp(saved, cippotto_framebuffer(emu), sizeof(saved)) == 0, "first handle unchanged");
+
+    uint8_t rom_start[2];
+    cippotto_read_memory(emu, 0x200, rom_start, sizeof(rom_start));
+    check(rom_start[0] == 0x60 && rom_start[1] == 0x00, "ROM at 0x200");
+
+    cippotto_snapshot_destroy(snapshot);
+    cippotto_destroy(other);
+    cippotto_destroy(emu);
+
+    if (failures > 0) {
+        return EXIT_FAILURE;
+    }
+    printf("snapshot restored through the C API\n");
+    return 0;
+}
@@ -0,0 +1,52 @@
+# Runs the same jobs through chip8_batch with and without --lockstep and
+# fails unless every job reports the same frames, cycles and hash. KEYS_ROM
+# draws with CXNN and branches on EX9E/EXA1 and FX0A, so it is run with
+# several seeds and held keys.
+#   cmake -DBATCH=<chip8_batch> -DROM=<rom> -DKEYS_ROM=<rom> -DWORK_DIR=<dir> -P CompareLockstep.cmake
+
+set(jobs "${WORK_DIR}/lockstep_jobs.txt")
+file(WRITE "${jobs}" "")
+foreach(seed RANGE 0 9)
+    file(APPEND "${jobs}" "${ROM} ${seed} 300\n")
+endforeach()
+# A second frame budget, so the groups split
+foreach(seed RANGE 10 12)
+    file(APPEND "${jobs}" "${ROM} ${seed} 120\n")
+endforeach()
+# Each held key mask with two seeds; no keys leaves FX0A waiting
+foreach(keys 0 1 8421 FFFF)
+    foreach(seed 1 2)
+        file(APPEND "${jobs}" "${KEYS_ROM} ${seed} 300 ${keys}\n")
+    endforeach()
+endforeach()
+
+foreach(mode scalar lockstep)
+    if(mode STREQUAL "lockstep")
+        set(extra --lockstep 4)
+    else()
+        set(extra)
+    endif()
+    execute_process(
+        COMMAND "${BATCH}" "${jobs}" --threads 2 --report "${WORK_DIR}/lockstep_${mode}.csv" ${extra}
+        RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "chip8_batch (${mode}) failed: ${result}")
+    endif()
+
+    # Drop wall_ms, the only column allowed to differ
+    file(STRINGS "${WORK_DIR}/lockstep_${mode}.csv" lines)
+    set(rows_${mode})
+    foreach(line IN LISTS lines)
+        string(REGEX REPLACE ",[0-9.]+,([a-z]+)$" ",\\1" line "${line}")
+        list(APPEND rows_${mode} "${line}")
+    endforeach()
+endforeach()
+
+list(LENGTH rows_scalar count)
+if(NOT count EQUAL 22)
+    message(FATAL_ERROR "Expected 21 jobs and a header, got ${count} lines")
+endif()
+if(NOT rows_scalar STREQUAL rows_lockstep)
+    message(FATAL_ERROR "Lockstep results differ:\n${rows_scalar}\nvs\n${rows_lockstep}")
+endif()
+message(STATUS "${count} lines identical with and without --lockstep")
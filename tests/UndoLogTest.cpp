@@ -0,0 +1,59 @@
+// Steps forward through a short ROM, then back again with UndoLog, and fails
+// unless every step back restores the exact state from before that
+// instruction. FX55 and FX33 write past 0xFFF, which the core wraps to 0x000.
+#include "chip8.h"
+#include "UndoLog.h"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+static int failures = 0;
+
+static void Check(bool ok, const char* what, size_t step) {
+    if (!ok) {
+        std::cerr << "Step " << step << ": " << what << std::endl;
+        ++failures;
+    }
+}
+
+int main()
+{
+    const uint8_t rom[] = {
+        0x60, 0x11,     // V0 = 0x11
+        0x61, 0x22,     // V1 = 0x22
+        0x62, 0x33,     // V2 = 0x33
+        0x63, 0xFE,     // V3 = 254
+        0xAF, 0xFE,     // I = 0xFFE
+        0xF3, 0x55,     // V0-V3 to 0xFFE, 0xFFF, 0x000, 0x001
+        0xAF, 0xFF,     // I = 0xFFF
+        0xF3, 0x33,     // BCD of V3 to 0xFFF, 0x000, 0x001
+    };
+    const size_t steps = sizeof(rom) / 2;
+
+    chip8 emulator;
+    if (!emulator.LoadROM(rom, sizeof(rom))) {
+        return EXIT_FAILURE;
+    }
+
+    UndoLog undo;
+    std::vector<uint64_t> before;
+    for (size_t step = 0; step < steps; ++step) {
+        before.push_back(emulator.hashState());
+        undo.Record(emulator);
+        emulator.emulateCycle();
+    }
+    Check(emulator.memory[0xFFF] == 2 && emulator.memory[0x000] == 5 && emulator.memory[0x001] == 4,
+          "BCD did not wrap to 0x000", steps);
+
+    for (size_t step = steps; step-- > 0;) {
+        Check(undo.StepBack(emulator), "nothing to step back to", step);
+        Check(emulator.hashState() == before[step], "state differs after stepping back", step);
+    }
+    Check(!undo.StepBack(emulator), "log longer than the steps run", 0);
+
+    if (failures > 0) {
+        return EXIT_FAILURE;
+    }
+    std::cout << steps << " steps undone" << std::endl;
+    return 0;
+}